@@ -714,7 +714,7 @@ void Updates::getDifference() {
 		differenceDone(result);
 	}).fail([=](const MTP::Error &error) {
 		differenceFail(error);
-	}).send();
+	}).parseInBackground().send();
 }
 
 void Updates::getChannelDifference(
@@ -751,7 +751,7 @@ void Updates::getChannelDifference(
 		channelDifferenceDone(channel, result);
 	}).fail([=](const MTP::Error &error) {
 		channelDifferenceFail(channel, error);
-	}).send();
+	}).parseInBackground().send();
 }
 
 void Updates::sendPing() {
@@ -25,9 +25,9 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/mime_type.h"
 #include "storage/file_download.h"
 #include "ui/chat/attach/attach_prepare.h"
+#include "ui/image/image_read_scaled.h"
 
 #include <QtCore/QBuffer>
-#include <QtGui/QImageReader>
 
 namespace Data {
 namespace {
@@ -79,27 +79,12 @@ enum class FileType {
 			.gzipSvg = true,
 		}).image;
 	}
-	auto buffer = QBuffer(&data);
-	auto file = QFile(path);
-	auto device = data.isEmpty() ? static_cast<QIODevice*>(&file) : &buffer;
-	auto reader = QImageReader(device);
-	const auto size = reader.size();
-	if (!reader.canRead()
-		|| (size.width() * size.height() > kReadAreaLimit)) {
-		return QImage();
-	}
-	auto result = reader.read();
-	if (!result.width() || !result.height()) {
-		return QImage();
-	}
-	return (result.width() > kWallPaperThumbnailLimit
-		|| result.height() > kWallPaperThumbnailLimit)
-		? result.scaled(
-			kWallPaperThumbnailLimit,
-			kWallPaperThumbnailLimit,
-			Qt::KeepAspectRatio,
-			Qt::SmoothTransformation)
-		: result;
+	return Images::ReadScaled({
+		.path = path,
+		.content = std::move(data),
+		.box = QSize(kWallPaperThumbnailLimit, kWallPaperThumbnailLimit),
+		.areaLimit = kReadAreaLimit,
+	});
 }
 
 } // namespace
@@ -321,8 +321,10 @@ const GroupCallParticipant *GroupCall::participantByPeer(
 
 GroupCallParticipant *GroupCall::findParticipant(
 		not_null<PeerData*> peer) {
-	const auto i = ranges::find(_participants, peer, &Participant::peer);
-	return (i != end(_participants)) ? &*i : nullptr;
+	const auto i = _participantIndexByPeer.find(peer);
+	return (i != end(_participantIndexByPeer))
+		? &_participants[i->second]
+		: nullptr;
 }
 
 const GroupCallParticipant *GroupCall::participantByEndpoint(
@@ -330,13 +332,41 @@ const GroupCallParticipant *GroupCall::participantByEndpoint(
 	if (endpoint.empty()) {
 		return nullptr;
 	}
-	for (const auto &participant : _participants) {
-		if (GetCameraEndpoint(participant.videoParams) == endpoint
-			|| GetScreenEndpoint(participant.videoParams) == endpoint) {
-			return &participant;
+	const auto i = _participantPeerByEndpoint.find(endpoint);
+	return (i != end(_participantPeerByEndpoint))
+		? participantByPeer(i->second)
+		: nullptr;
+}
+
+void GroupCall::indexParticipantEndpoints(const Participant &participant) {
+	const auto add = [&](const std::string &endpoint) {
+		if (!endpoint.empty()) {
+			_participantPeerByEndpoint.insert_or_assign(
+				endpoint,
+				participant.peer);
 		}
+	};
+	add(GetCameraEndpoint(participant.videoParams));
+	add(GetScreenEndpoint(participant.videoParams));
+}
+
+void GroupCall::unindexParticipantEndpoints(
+		const Participant &participant) {
+	const auto remove = [&](const std::string &endpoint) {
+		const auto i = _participantPeerByEndpoint.find(endpoint);
+		if (i != end(_participantPeerByEndpoint)
+			&& i->second == participant.peer) {
+			_participantPeerByEndpoint.erase(i);
+		}
+	};
+	remove(GetCameraEndpoint(participant.videoParams));
+	remove(GetScreenEndpoint(participant.videoParams));
+}
+
+void GroupCall::reindexParticipants(int from) {
+	for (auto i = from, count = int(_participants.size()); i != count; ++i) {
+		_participantIndexByPeer[_participants[i].peer] = i;
 	}
-	return nullptr;
 }
 
 rpl::producer<> GroupCall::participantsReloaded() {
@@ -473,6 +503,8 @@ void GroupCall::processFullCallFields(const MTPphone_GroupCall &call) {
 		const auto nextOffset = qs(data.vparticipants_next_offset());
 		data.vcall().match([&](const MTPDgroupCall &data) {
 			_participants.clear();
+			_participantIndexByPeer.clear();
+			_participantPeerByEndpoint.clear();
 			_speakingByActiveFinishes.clear();
 			_participantPeerByAudioSsrc.clear();
 			_allParticipantsLoaded = false;
@@ -677,10 +709,10 @@ void GroupCall::applyParticipantsSlice(
 			const auto participantPeerId = peerFromMTP(data.vpeer());
 			const auto participantPeer = _peer->owner().peer(
 				participantPeerId);
-			const auto i = ranges::find(
-				_participants,
-				participantPeer,
-				&Participant::peer);
+			const auto index = _participantIndexByPeer.find(participantPeer);
+			const auto i = (index != end(_participantIndexByPeer))
+				? (begin(_participants) + index->second)
+				: end(_participants);
 			if (data.is_left()) {
 				if (i != end(_participants)) {
 					auto update = ParticipantUpdate{
@@ -690,7 +722,11 @@ void GroupCall::applyParticipantsSlice(
 					_participantPeerByAudioSsrc.erase(
 						GetAdditionalAudioSsrc(i->videoParams));
 					_speakingByActiveFinishes.remove(participantPeer);
+					unindexParticipantEndpoints(*i);
+					_participantIndexByPeer.erase(index);
+					const auto position = int(i - begin(_participants));
 					_participants.erase(i);
+					reindexParticipants(position);
 					if (sliceSource != ApplySliceSource::FullReloaded) {
 						_participantUpdates.fire(std::move(update));
 					}
@@ -773,7 +809,11 @@ void GroupCall::applyParticipantsSlice(
 						additional,
 						participantPeer);
 				}
+				_participantIndexByPeer.emplace(
+					participantPeer,
+					int(_participants.size()));
 				_participants.push_back(value);
+				indexParticipantEndpoints(value);
 			} else {
 				if (i->ssrc != value.ssrc) {
 					_participantPeerByAudioSsrc.erase(i->ssrc);
@@ -794,7 +834,14 @@ void GroupCall::applyParticipantsSlice(
 							participantPeer);
 					}
 				}
+				const auto reindex = (i->videoParams != value.videoParams);
+				if (reindex) {
+					unindexParticipantEndpoints(*i);
+				}
 				*i = value;
+				if (reindex) {
+					indexParticipantEndpoints(value);
+				}
 			}
 			if (data.is_just_joined()) {
 				++_serverParticipantsCount;
@@ -1030,11 +1077,7 @@ void GroupCall::requestUnknownParticipants() {
 		}
 		for (const auto &[id, when] : participantPeerIds) {
 			if (const auto participantPeer = _peer->owner().peerLoaded(id)) {
-				const auto isParticipant = ranges::contains(
-					_participants,
-					not_null{ participantPeer },
-					&Participant::peer);
-				if (isParticipant) {
+				if (_participantIndexByPeer.contains(participantPeer)) {
 					applyActiveUpdate(id, when, participantPeer);
 				}
 			}
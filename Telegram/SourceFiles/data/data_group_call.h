@@ -224,6 +224,9 @@ private:
 	[[nodiscard]] bool processSavedFullCall();
 	void finishParticipantsSliceRequest();
 	[[nodiscard]] Participant *findParticipant(not_null<PeerData*> peer);
+	void indexParticipantEndpoints(const Participant &participant);
+	void unindexParticipantEndpoints(const Participant &participant);
+	void reindexParticipants(int from);
 
 	const CallId _id = 0;
 	const uint64 _accessHash = 0;
@@ -243,6 +246,10 @@ private:
 	std::optional<MTPphone_GroupCall> _savedFull;
 
 	std::vector<Participant> _participants;
+	std::unordered_map<not_null<PeerData*>, int> _participantIndexByPeer;
+	std::unordered_map<
+		std::string,
+		not_null<PeerData*>> _participantPeerByEndpoint;
 	base::flat_map<uint32, not_null<PeerData*>> _participantPeerByAudioSsrc;
 	base::flat_map<not_null<PeerData*>, crl::time> _speakingByActiveFinishes;
 	base::Timer _speakingByActiveFinishTimer;
@@ -7,6 +7,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #pragma once
 
+#include "statistics/min_max_pyramid.h"
 #include "statistics/segment_tree.h"
 
 namespace Data {
@@ -39,6 +40,7 @@ struct StatisticalChart {
 		std::vector<Statistic::ChartValue> y;
 
 		Statistic::SegmentTree segmentTree;
+		Statistic::MinMaxPyramid pyramid;
 		int id = 0;
 		QString idString;
 		QString name;
@@ -297,8 +297,14 @@ Storage::Cache::Key CustomEmojiLoader::cacheKey(
 	if (!baseKey) {
 		return {};
 	}
+	// Frames of an overridden size are stored in separate records,
+	// the high 32 bits of a document base key are always zero.
+	const auto size = FrameSizeFromTag(_tag, _sizeOverride);
+	const auto sized = (size != FrameSizeFromTag(_tag))
+		? (uint64(uint32(size)) << 32)
+		: 0ULL;
 	return Storage::Cache::Key{
-		baseKey.high,
+		baseKey.high | sized,
 		baseKey.low + ChatHelpers::LottieCacheKeyShift(
 			0x0F,
 			LottieSizeFromTag(_tag)),
@@ -482,9 +488,12 @@ std::unique_ptr<Ui::Text::CustomEmoji> CustomEmojiManager::create(
 		SizeTag tag,
 		int sizeOverride,
 		LoaderFactory factory) {
-	auto &instances = _instances[SizeIndex(tag)];
-	auto i = instances.find(documentId);
-	if (i == end(instances)) {
+	const auto key = InstanceKey{
+		documentId,
+		FrameSizeFromTag(tag, sizeOverride),
+	};
+	auto i = _instances.find(key);
+	if (i == end(_instances)) {
 		using Loading = Ui::CustomEmoji::Loading;
 		const auto repaint = [=](
 				not_null<Ui::CustomEmoji::Instance*> instance,
@@ -492,8 +501,8 @@ std::unique_ptr<Ui::Text::CustomEmoji> CustomEmojiManager::create(
 			repaintLater(instance, request);
 		};
 		auto [loader, setId, colored] = factory();
-		i = instances.emplace(
-			documentId,
+		i = _instances.emplace(
+			key,
 			std::make_unique<Ui::CustomEmoji::Instance>(Loading{
 				std::move(loader),
 				prepareNonExactPreview(documentId, tag, sizeOverride)
@@ -524,27 +533,35 @@ Ui::CustomEmoji::Preview CustomEmojiManager::prepareNonExactPreview(
 		DocumentId documentId,
 		SizeTag tag,
 		int sizeOverride) const {
-	for (auto i = _instances.size(); i != 0;) {
-		if (SizeIndex(tag) == --i) {
+	const auto size = FrameSizeFromTag(tag, sizeOverride);
+
+	// Prefer downscaling from the closest larger size, it looks better.
+	auto best = QImage();
+	auto bestSize = 0;
+	const auto from = _instances.lower_bound(InstanceKey{ documentId, 0 });
+	for (auto i = from; i != end(_instances); ++i) {
+		if (i->first.documentId != documentId) {
+			break;
+		} else if (i->first.size == size) {
 			continue;
-		}
-		const auto &other = _instances[i];
-		const auto j = other.find(documentId);
-		if (j == end(other)) {
-			continue;
-		} else if (const auto nonExact = j->second->imagePreview()) {
-			const auto size = FrameSizeFromTag(tag, sizeOverride);
-			return {
-				nonExact.image().scaled(
-					size,
-					size,
-					Qt::IgnoreAspectRatio,
-					Qt::SmoothTransformation),
-				false,
-			};
+		} else if (bestSize >= size && i->first.size > bestSize) {
+			break;
+		} else if (const auto nonExact = i->second->imagePreview()) {
+			best = nonExact.image();
+			bestSize = i->first.size;
 		}
 	}
-	return {};
+	if (best.isNull()) {
+		return {};
+	}
+	return {
+		best.scaled(
+			size,
+			size,
+			Qt::IgnoreAspectRatio,
+			Qt::SmoothTransformation),
+		false,
+	};
 }
 
 std::unique_ptr<Ui::Text::CustomEmoji> CustomEmojiManager::create(
@@ -799,11 +816,12 @@ void CustomEmojiManager::request() {
 void CustomEmojiManager::fillColoredFlags(not_null<DocumentData*> document) {
 	if (document->emojiUsesTextColor()) {
 		const auto id = document->id;
-		for (auto &instances : _instances) {
-			const auto i = instances.find(id);
-			if (i != end(instances)) {
-				i->second->setColored();
+		const auto from = _instances.lower_bound(InstanceKey{ id, 0 });
+		for (auto i = from; i != end(_instances); ++i) {
+			if (i->first.documentId != id) {
+				break;
 			}
+			i->second->setColored();
 		}
 	}
 }
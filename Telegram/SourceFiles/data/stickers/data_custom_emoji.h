@@ -93,6 +93,12 @@ public:
 private:
 	static constexpr auto kSizeCount = int(SizeTag::kCount);
 
+	struct InstanceKey {
+		DocumentId documentId = 0;
+		int size = 0;
+
+		friend inline auto operator<=>(InstanceKey, InstanceKey) = default;
+	};
 	struct InternalEmojiData {
 		QImage image;
 		bool textColor = true;
@@ -148,11 +154,10 @@ private:
 
 	const not_null<Session*> _owner;
 
-	std::array<
-		base::flat_map<
-			DocumentId,
-			std::unique_ptr<Ui::CustomEmoji::Instance>>,
-		kSizeCount> _instances;
+	// Different size tags with the same frame size share decoded frames.
+	base::flat_map<
+		InstanceKey,
+		std::unique_ptr<Ui::CustomEmoji::Instance>> _instances;
 	std::array<
 		base::flat_map<
 			DocumentId,
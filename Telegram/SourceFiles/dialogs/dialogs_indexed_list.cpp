@@ -12,6 +12,23 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/history.h"
 
 namespace Dialogs {
+namespace {
+
+constexpr auto kMinIndexPrefix = 2;
+constexpr auto kMaxIndexPrefix = 3;
+
+[[nodiscard]] base::flat_set<QString> CollectPrefixes(Key key) {
+	auto result = base::flat_set<QString>();
+	for (const auto &word : key.entry()->chatListNameWords()) {
+		const auto till = std::min(int(word.size()), kMaxIndexPrefix);
+		for (auto length = kMinIndexPrefix; length <= till; ++length) {
+			result.emplace(word.left(length));
+		}
+	}
+	return result;
+}
+
+} // namespace
 
 IndexedList::IndexedList(SortMode sortMode, FilterId filterId)
 : _sortMode(sortMode)
@@ -20,6 +37,12 @@ IndexedList::IndexedList(SortMode sortMode, FilterId filterId)
 , _empty(sortMode, filterId) {
 }
 
+void IndexedList::enablePrefixIndex() {
+	Expects(empty());
+
+	_prefixIndex = true;
+}
+
 RowsByLetter IndexedList::addToEnd(Key key) {
 	if (const auto row = _list.getRow(key)) {
 		return { row };
@@ -33,6 +56,7 @@ RowsByLetter IndexedList::addToEnd(Key key) {
 		}
 		result.letters.emplace(ch, j->second.addToEnd(key));
 	}
+	indexPrefixes(key);
 	return result;
 }
 
@@ -49,6 +73,7 @@ Row *IndexedList::addByName(Key key) {
 		}
 		j->second.addByName(key);
 	}
+	indexPrefixes(key);
 	return result;
 }
 
@@ -127,6 +152,8 @@ void IndexedList::adjustByName(
 	const auto mainRow = _list.adjustByName(key);
 	if (!mainRow) return;
 
+	indexPrefixes(key);
+
 	auto toRemove = oldLetters;
 	auto toAdd = base::flat_set<QChar>();
 	for (const auto &ch : key.entry()->chatListFirstLetters()) {
@@ -164,6 +191,8 @@ void IndexedList::adjustNames(
 	auto mainRow = _list.getRow(key);
 	if (!mainRow) return;
 
+	indexPrefixes(key);
+
 	auto toRemove = oldLetters;
 	auto toAdd = base::flat_set<QChar>();
 	for (const auto &ch : key.entry()->chatListFirstLetters()) {
@@ -201,40 +230,96 @@ void IndexedList::remove(Key key, Row *replacedBy) {
 				it->second.remove(key, replacedBy);
 			}
 		}
+		removePrefixes(key);
 	}
 }
 
 void IndexedList::clear() {
 	_list.clear();
 	_index.clear();
+	_prefixes.clear();
+	_prefixesByKey.clear();
+}
+
+void IndexedList::indexPrefixes(Key key) {
+	if (!_prefixIndex) {
+		return;
+	}
+	auto now = CollectPrefixes(key);
+	auto &was = _prefixesByKey[key];
+	for (const auto &prefix : was) {
+		if (!now.contains(prefix)) {
+			removePrefix(prefix, key);
+		}
+	}
+	for (const auto &prefix : now) {
+		if (!was.contains(prefix)) {
+			_prefixes[prefix].emplace(key.entry());
+		}
+	}
+	was = std::move(now);
+}
+
+void IndexedList::removePrefixes(Key key) {
+	const auto i = _prefixesByKey.find(key);
+	if (i == end(_prefixesByKey)) {
+		return;
+	}
+	for (const auto &prefix : i->second) {
+		removePrefix(prefix, key);
+	}
+	_prefixesByKey.erase(i);
+}
+
+void IndexedList::removePrefix(const QString &prefix, Key key) {
+	const auto i = _prefixes.find(prefix);
+	if (i != end(_prefixes)) {
+		i->second.erase(key.entry());
+		if (i->second.empty()) {
+			_prefixes.erase(i);
+		}
+	}
 }
 
 std::vector<not_null<Row*>> IndexedList::filtered(
 		const QStringList &words) const {
-	const auto minimal = [&]() -> const Dialogs::List* {
-		if (empty()) {
-			return nullptr;
-		}
-		auto result = (const Dialogs::List*)nullptr;
-		for (const auto &word : words) {
-			if (word.isEmpty()) {
-				continue;
-			}
+	auto result = std::vector<not_null<Row*>>();
+	if (empty()) {
+		return result;
+	}
+
+	// Find the smallest candidates set: a letter list for one letter
+	// words and a prefix bucket for longer ones.
+	auto minimalList = (const Dialogs::List*)nullptr;
+	auto minimalEntries = (const std::unordered_set<not_null<Entry*>>*)nullptr;
+	auto minimalSize = 0;
+	for (const auto &word : words) {
+		if (word.isEmpty()) {
+			continue;
+		} else if (!_prefixIndex || word.size() < kMinIndexPrefix) {
 			const auto found = filtered(word[0]);
 			if (!found || found->empty()) {
-				return nullptr;
-			} else if (!result || result->size() > found->size()) {
-				result = found;
+				return result;
+			} else if (!minimalSize || found->size() < minimalSize) {
+				minimalList = found;
+				minimalEntries = nullptr;
+				minimalSize = found->size();
+			}
+		} else {
+			const auto i = _prefixes.find(word.left(kMaxIndexPrefix));
+			if (i == end(_prefixes)) {
+				return result;
+			} else if (!minimalSize || int(i->second.size()) < minimalSize) {
+				minimalList = nullptr;
+				minimalEntries = &i->second;
+				minimalSize = int(i->second.size());
 			}
 		}
-		return result;
-	}();
-	auto result = std::vector<not_null<Row*>>();
-	if (!minimal || minimal->empty()) {
+	}
+	if (!minimalSize) {
 		return result;
 	}
-	result.reserve(minimal->size());
-	for (const auto &row : *minimal) {
+	const auto matches = [&](not_null<Row*> row) {
 		const auto &nameWords = row->entry()->chatListNameWords();
 		const auto found = [&](const QString &word) {
 			for (const auto &name : nameWords) {
@@ -244,17 +329,31 @@ std::vector<not_null<Row*>> IndexedList::filtered(
 			}
 			return false;
 		};
-		const auto allFound = [&] {
-			for (const auto &word : words) {
-				if (!found(word)) {
-					return false;
-				}
+		for (const auto &word : words) {
+			if (!found(word)) {
+				return false;
 			}
-			return true;
-		}();
-		if (allFound) {
-			result.push_back(row);
 		}
+		return true;
+	};
+	result.reserve(minimalSize);
+	if (minimalList) {
+		for (const auto &row : *minimalList) {
+			if (matches(row)) {
+				result.push_back(row);
+			}
+		}
+	} else {
+		for (const auto &entry : *minimalEntries) {
+			if (const auto row = _list.getRow(entry); row && matches(row)) {
+				result.push_back(row);
+			}
+		}
+
+		// Keep the same order as in the letter lists.
+		ranges::sort(result, ranges::less(), [](not_null<Row*> row) {
+			return row->index();
+		});
 	}
 	return result;
 }
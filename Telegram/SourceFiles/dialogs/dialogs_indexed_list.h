@@ -20,6 +20,9 @@ class IndexedList {
 public:
 	IndexedList(SortMode sortMode, FilterId filterId = 0);
 
+	// Only for lists searched by filtered(words), must be empty.
+	void enablePrefixIndex();
+
 	RowsByLetter addToEnd(Key key);
 	Row *addByName(Key key);
 	void adjustByDate(const RowsByLetter &links);
@@ -92,12 +95,21 @@ private:
 		FilterId filterId,
 		not_null<History*> history,
 		const base::flat_set<QChar> &oldChars);
+	void indexPrefixes(Key key);
+	void removePrefixes(Key key);
+	void removePrefix(const QString &prefix, Key key);
 
 	SortMode _sortMode = SortMode();
 	FilterId _filterId = 0;
 	List _list, _empty;
 	base::flat_map<QChar, List> _index;
 
+	// Entries by short prefixes of their name words, to find candidates
+	// for longer queries without checking each row of a letter list.
+	std::map<QString, std::unordered_set<not_null<Entry*>>> _prefixes;
+	std::map<Key, base::flat_set<QString>> _prefixesByKey;
+	bool _prefixIndex = false;
+
 };
 
 } // namespace Dialogs
@@ -25,6 +25,11 @@ MainList::MainList(
 , _pinned(filterId, 1) {
 	_unreadState.known = true;
 
+	// Chat filter lists are never searched by name.
+	if (!filterId) {
+		_all.enablePrefixIndex();
+	}
+
 	std::move(
 		pinnedLimit
 	) | rpl::start_with_next([=](int limit) {
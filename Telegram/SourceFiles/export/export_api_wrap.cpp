@@ -11,10 +11,12 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "export/data/export_data_types.h"
 #include "export/output/export_output_result.h"
 #include "export/output/export_output_file.h"
+#include "export/output/export_output_manifest.h"
 #include "mtproto/mtproto_response.h"
 #include "base/bytes.h"
 #include "base/options.h"
 #include "base/random.h"
+#include <QtCore/QCryptographicHash>
 #include <set>
 #include <deque>
 
@@ -23,8 +25,8 @@ namespace {
 
 constexpr auto kUserpicsSliceLimit = 100;
 constexpr auto kFileChunkSize = 128 * 1024;
-constexpr auto kFileRequestsCount = 2;
-//constexpr auto kFileNextRequestDelay = crl::time(20);
+constexpr auto kFileRequestsMin = 2;
+constexpr auto kFileRequestsMax = 8;
 constexpr auto kChatsSliceLimit = 100;
 constexpr auto kMessagesSliceLimit = 100;
 constexpr auto kTopPeerSliceLimit = 100;
@@ -178,8 +180,14 @@ struct ApiWrap::FileProcess {
 	struct Request {
 		int64 offset = 0;
 		QByteArray bytes;
+		mtpRequestId requestId = 0;
 	};
 	std::deque<Request> requests;
+	int requestsLimit = kFileRequestsMin;
+	QCryptographicHash checksum = QCryptographicHash(
+		QCryptographicHash::Md5);
+
+	// File reference refresh.
 	mtpRequestId requestId = 0;
 };
 
@@ -220,6 +228,11 @@ struct ApiWrap::ChatProcess {
 
 	FnMut<void(MTPmessages_Messages&&)> requestDone;
 
+	// Next slice is requested while files of the current one are loading.
+	std::optional<MTPmessages_Messages> preloaded;
+	bool preloading = false;
+	bool waitingPreloaded = false;
+
 	int localSplitIndex = 0;
 	int32 largestIdPlusOne = 1;
 
@@ -382,11 +395,11 @@ auto ApiWrap::fileRequest(const Data::FileLocation &location, int64 offset) {
 			MTP_long(offset),
 			MTP_int(kFileChunkSize))
 	)).fail([=](const MTP::Error &result) {
-		_fileProcess->requestId = 0;
+		const auto restart = filePartFailed(offset);
 		if (result.type() == u"TAKEOUT_FILE_EMPTY"_q
 			&& _otherDataProcess != nullptr) {
 			filePartDone(
-				0,
+				restart,
 				MTP_upload_file(
 					MTP_storage_filePartial(),
 					MTP_int(0),
@@ -397,7 +410,7 @@ auto ApiWrap::fileRequest(const Data::FileLocation &location, int64 offset) {
 			filePartUnavailable();
 		} else if (result.code() == 400
 			&& result.type().startsWith(u"FILE_REFERENCE_"_q)) {
-			filePartRefreshReference(offset);
+			filePartRefreshReference(restart);
 		} else {
 			error(std::move(result));
 		}
@@ -428,6 +441,7 @@ void ApiWrap::startExport(
 
 	_settings = std::make_unique<Settings>(settings);
 	_stats = stats;
+	_manifest = std::make_unique<Output::Manifest>(_settings->path);
 	_startProcess = std::make_unique<StartProcess>();
 	_startProcess->done = std::move(done);
 
@@ -1276,8 +1290,7 @@ void ApiWrap::skipFile(uint64 randomId) {
 	}
 	LOG(("Export Info: File skipped."));
 	Assert(!_fileProcess->requests.empty());
-	Assert(_fileProcess->requestId != 0);
-	_mtp.request(base::take(_fileProcess->requestId)).cancel();
+	cancelFileRequests();
 	base::take(_fileProcess)->done(QString());
 }
 
@@ -1601,6 +1614,12 @@ void ApiWrap::requestMessagesSlice() {
 	if (!count) {
 		loadMessagesFiles({});
 		return;
+	} else if (_chatProcess->preloaded) {
+		messagesSliceReceived(*base::take(_chatProcess->preloaded));
+		return;
+	} else if (_chatProcess->preloading) {
+		_chatProcess->waitingPreloaded = true;
+		return;
 	}
 	requestChatMessages(
 		_chatProcess->info.splits[_chatProcess->localSplitIndex],
@@ -1608,21 +1627,52 @@ void ApiWrap::requestMessagesSlice() {
 		-kMessagesSliceLimit,
 		kMessagesSliceLimit,
 		[=](const MTPmessages_Messages &result) {
+		messagesSliceReceived(result);
+	});
+}
+
+void ApiWrap::preloadMessagesSlice(int32 largestIdPlusOne) {
+	Expects(_chatProcess != nullptr);
+	Expects(!_chatProcess->preloading);
+	Expects(!_chatProcess->preloaded.has_value());
+
+	_chatProcess->preloading = true;
+	requestChatMessages(
+		_chatProcess->info.splits[_chatProcess->localSplitIndex],
+		largestIdPlusOne,
+		-kMessagesSliceLimit,
+		kMessagesSliceLimit,
+		[=](MTPmessages_Messages &&result) {
 		Expects(_chatProcess != nullptr);
 
-		result.match([&](const MTPDmessages_messagesNotModified &data) {
-			error("Unexpected messagesNotModified received.");
-		}, [&](const auto &data) {
-			if constexpr (MTPDmessages_messages::Is<decltype(data)>()) {
-				_chatProcess->lastSlice = true;
-			}
-			loadMessagesFiles(Data::ParseMessagesSlice(
-				_chatProcess->context,
-				data.vmessages(),
-				data.vusers(),
-				data.vchats(),
-				_chatProcess->info.relativePath));
-		});
+		_chatProcess->preloading = false;
+		if (base::take(_chatProcess->waitingPreloaded)) {
+			messagesSliceReceived(result);
+		} else {
+			_chatProcess->preloaded = std::move(result);
+		}
+	});
+}
+
+void ApiWrap::messagesSliceReceived(const MTPmessages_Messages &result) {
+	Expects(_chatProcess != nullptr);
+
+	result.match([&](const MTPDmessages_messagesNotModified &data) {
+		error("Unexpected messagesNotModified received.");
+	}, [&](const auto &data) {
+		if constexpr (MTPDmessages_messages::Is<decltype(data)>()) {
+			_chatProcess->lastSlice = true;
+		}
+		auto slice = Data::ParseMessagesSlice(
+			_chatProcess->context,
+			data.vmessages(),
+			data.vusers(),
+			data.vchats(),
+			_chatProcess->info.relativePath);
+		if (!_chatProcess->lastSlice && !slice.list.empty()) {
+			preloadMessagesSlice(slice.list.back().id + 1);
+		}
+		loadMessagesFiles(std::move(slice));
 	});
 }
 
@@ -2072,11 +2122,32 @@ bool ApiWrap::processFileLoad(
 		// Don't load thumbs for large files that we skip.
 		file.skipReason = SkipReason::FileSize;
 		return true;
+	} else if (restorePreviousFile(file)) {
+		return true;
 	}
 	loadFile(file, origin, std::move(progress), std::move(done));
 	return false;
 }
 
+bool ApiWrap::restorePreviousFile(Data::File &file) {
+	Expects(_settings != nullptr);
+	Expects(_manifest != nullptr);
+
+	if (!file.location || !_manifest->previousCount()) {
+		return false;
+	}
+	const auto key = ComputeLocationKey(file.location);
+	const auto relativePath = Output::File::PrepareRelativePath(
+		_settings->path,
+		file.suggestedPath);
+	if (!_manifest->restore({ key.type, key.id }, relativePath, _stats)) {
+		return false;
+	}
+	file.relativePath = relativePath;
+	_fileCache->save(file.location, relativePath);
+	return true;
+}
+
 bool ApiWrap::writePreloadedFile(
 		Data::File &file,
 		const Data::FileOrigin &origin) {
@@ -2125,7 +2196,7 @@ void ApiWrap::loadFile(
 
 	loadFilePart();
 
-	Ensures(_fileProcess->requestId != 0);
+	Ensures(!_fileProcess->requests.empty());
 }
 
 auto ApiWrap::prepareFileProcess(
@@ -2149,36 +2220,59 @@ auto ApiWrap::prepareFileProcess(
 }
 
 void ApiWrap::loadFilePart() {
-	if (!_fileProcess
-		|| _fileProcess->requestId
-		|| _fileProcess->requests.size() >= kFileRequestsCount
-		|| (_fileProcess->size > 0
-			&& _fileProcess->offset >= _fileProcess->size)) {
+	if (!_fileProcess) {
 		return;
 	}
 
-	const auto offset = _fileProcess->offset;
-	_fileProcess->requests.push_back({ offset });
-	_fileProcess->requestId = fileRequest(
-		_fileProcess->location,
-		_fileProcess->offset
-	).done([=](const MTPupload_File &result) {
-		_fileProcess->requestId = 0;
-		filePartDone(offset, result);
-	}).send();
-	_fileProcess->offset += kFileChunkSize;
+	// Without a known size we don't know where the file ends.
+	const auto size = _fileProcess->size;
+	const auto limit = size ? _fileProcess->requestsLimit : 1;
+	while (int(_fileProcess->requests.size()) < limit
+		&& (!size || _fileProcess->offset < size)) {
+		const auto offset = _fileProcess->offset;
+		auto &request = _fileProcess->requests.emplace_back(
+			FileProcess::Request{ .offset = offset });
+		request.requestId = fileRequest(
+			_fileProcess->location,
+			offset
+		).done([=](const MTPupload_File &result) {
+			filePartDone(offset, result);
+		}).send();
+		_fileProcess->offset += kFileChunkSize;
+	}
+}
+
+int64 ApiWrap::filePartFailed(int64 offset) {
+	Expects(_fileProcess != nullptr);
+	Expects(!_fileProcess->requests.empty());
+
+	auto &requests = _fileProcess->requests;
+	for (auto &request : requests) {
+		if (request.offset == offset) {
+			request.requestId = 0;
+		}
+	}
+	cancelFileRequests();
 
-	if (_fileProcess->size > 0
-		&& _fileProcess->requests.size() < kFileRequestsCount) {
-		// Only one request at a time supported right now.
-		//const auto runner = _runner;
-		//crl::on_main([=] {
-		//	QTimer::singleShot(kFileNextRequestDelay, [=] {
-		//		runner([=] {
-		//			loadFilePart();
-		//		});
-		//	});
-		//});
+	// Parts are written in order, so start again from the first missing.
+	const auto result = requests.front().offset;
+	requests.clear();
+	requests.push_back({ result });
+	_fileProcess->offset = result + kFileChunkSize;
+	_fileProcess->requestsLimit = kFileRequestsMin;
+	return result;
+}
+
+void ApiWrap::cancelFileRequests() {
+	Expects(_fileProcess != nullptr);
+
+	for (auto &request : _fileProcess->requests) {
+		if (request.requestId) {
+			_mtp.request(base::take(request.requestId)).cancel();
+		}
+	}
+	if (_fileProcess->requestId) {
+		_mtp.request(base::take(_fileProcess->requestId)).cancel();
 	}
 }
 
@@ -2191,6 +2285,15 @@ void ApiWrap::filePartDone(int64 offset, const MTPupload_File &result) {
 		return;
 	}
 	const auto &data = result.c_upload_file();
+	using Request = FileProcess::Request;
+	auto &requests = _fileProcess->requests;
+	const auto i = ranges::find(
+		requests,
+		offset,
+		[](const Request &request) { return request.offset; });
+	Assert(i != end(requests));
+	i->requestId = 0;
+
 	if (data.vbytes().v.isEmpty()) {
 		if (_fileProcess->size > 0) {
 			error("Empty bytes received in file part.");
@@ -2202,14 +2305,6 @@ void ApiWrap::filePartDone(int64 offset, const MTPupload_File &result) {
 			return;
 		}
 	} else {
-		using Request = FileProcess::Request;
-		auto &requests = _fileProcess->requests;
-		const auto i = ranges::find(
-			requests,
-			offset,
-			[](const Request &request) { return request.offset; });
-		Assert(i != end(requests));
-
 		i->bytes = data.vbytes().v;
 
 		auto &file = _fileProcess->file;
@@ -2219,7 +2314,11 @@ void ApiWrap::filePartDone(int64 offset, const MTPupload_File &result) {
 				ioError(result);
 				return;
 			}
+			_fileProcess->checksum.addData(bytes);
 			requests.pop_front();
+			if (_fileProcess->requestsLimit < kFileRequestsMax) {
+				++_fileProcess->requestsLimit;
+			}
 		}
 
 		if (_fileProcess->progress) {
@@ -2239,6 +2338,14 @@ void ApiWrap::filePartDone(int64 offset, const MTPupload_File &result) {
 	auto process = base::take(_fileProcess);
 	const auto relativePath = process->relativePath;
 	_fileCache->save(process->location, relativePath);
+	if (process->size > 0 && process->file.size() == process->size) {
+		const auto key = ComputeLocationKey(process->location);
+		_manifest->append(
+			{ key.type, key.id },
+			relativePath,
+			process->size,
+			process->checksum.result());
+	}
 	process->done(process->relativePath);
 }
 
@@ -2334,13 +2441,7 @@ void ApiWrap::filePartExtractReference(
 					_fileProcess->location,
 					message.thumb().file.location);
 				if (refresh1 || refresh2) {
-					_fileProcess->requestId = fileRequest(
-						_fileProcess->location,
-						offset
-					).done([=](const MTPupload_File &result) {
-						_fileProcess->requestId = 0;
-						filePartDone(offset, result);
-					}).send();
+					filePartRetry(offset);
 					return;
 				}
 			}
@@ -2367,13 +2468,7 @@ void ApiWrap::filePartExtractReference(
 				_fileProcess->location,
 				story.thumb().file.location);
 			if (refresh1 || refresh2) {
-				_fileProcess->requestId = fileRequest(
-					_fileProcess->location,
-					offset
-				).done([=](const MTPupload_File &result) {
-					_fileProcess->requestId = 0;
-					filePartDone(offset, result);
-				}).send();
+				filePartRetry(offset);
 				return;
 			}
 		}
@@ -2381,12 +2476,26 @@ void ApiWrap::filePartExtractReference(
 	filePartUnavailable();
 }
 
+void ApiWrap::filePartRetry(int64 offset) {
+	Expects(_fileProcess != nullptr);
+	Expects(_fileProcess->requests.size() == 1);
+	Expects(_fileProcess->requests.front().offset == offset);
+
+	_fileProcess->requests.front().requestId = fileRequest(
+		_fileProcess->location,
+		offset
+	).done([=](const MTPupload_File &result) {
+		filePartDone(offset, result);
+	}).send();
+}
+
 void ApiWrap::filePartUnavailable() {
 	Expects(_fileProcess != nullptr);
 	Expects(!_fileProcess->requests.empty());
 
 	LOG(("Export Error: File unavailable."));
 
+	cancelFileRequests();
 	base::take(_fileProcess)->done(QString());
 }
 
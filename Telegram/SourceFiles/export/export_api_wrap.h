@@ -34,6 +34,7 @@ struct FileOrigin;
 namespace Output {
 struct Result;
 class Stats;
+class Manifest;
 } // namespace Output
 
 struct Settings;
@@ -175,6 +176,8 @@ private:
 	void checkFirstMessageDate(int localSplitIndex, int count);
 	void messagesCountLoaded(int localSplitIndex, int count);
 	void requestMessagesSlice();
+	void preloadMessagesSlice(int32 largestIdPlusOne);
+	void messagesSliceReceived(const MTPmessages_Messages &result);
 	void requestChatMessages(
 		int splitIndex,
 		int offsetId,
@@ -209,6 +212,7 @@ private:
 	std::unique_ptr<FileProcess> prepareFileProcess(
 		const Data::File &file,
 		const Data::FileOrigin &origin) const;
+	bool restorePreviousFile(Data::File &file);
 	bool writePreloadedFile(
 		Data::File &file,
 		const Data::FileOrigin &origin);
@@ -218,6 +222,8 @@ private:
 		Fn<bool(FileProgress)> progress,
 		FnMut<void(QString)> done);
 	void loadFilePart();
+	[[nodiscard]] int64 filePartFailed(int64 offset);
+	void cancelFileRequests();
 	void filePartDone(int64 offset, const MTPupload_File &result);
 	void filePartUnavailable();
 	void filePartRefreshReference(int64 offset);
@@ -227,6 +233,7 @@ private:
 	void filePartExtractReference(
 		int64 offset,
 		const MTPstories_Stories &result);
+	void filePartRetry(int64 offset);
 
 	template <typename Request>
 	class RequestBuilder;
@@ -255,6 +262,7 @@ private:
 
 	std::unique_ptr<StartProcess> _startProcess;
 	std::unique_ptr<LoadedFileCache> _fileCache;
+	std::unique_ptr<Output::Manifest> _manifest;
 	std::unique_ptr<ContactsProcess> _contactsProcess;
 	std::unique_ptr<UserpicsProcess> _userpicsProcess;
 	std::unique_ptr<StoriesProcess> _storiesProcess;
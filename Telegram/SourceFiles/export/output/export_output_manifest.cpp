@@ -0,0 +1,172 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "export/output/export_output_manifest.h"
+
+#include "export/output/export_output_file.h"
+#include "export/output/export_output_result.h"
+#include "export/output/export_output_stats.h"
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDir>
+
+namespace Export {
+namespace Output {
+namespace {
+
+constexpr auto kFileName = "export_manifest.txt";
+constexpr auto kHeader = "tdesktop-export-manifest 1";
+constexpr auto kCopyBlockSize = 1024 * 1024;
+constexpr auto kChecksumSize = 16;
+
+} // namespace
+
+Manifest::Manifest(const QString &folder) : _folder(folder) {
+	loadPrevious();
+	if (!_previous.empty()) {
+		LOG(("Export Info: Found %1 files in previous exports."
+			).arg(_previous.size()));
+	}
+}
+
+int Manifest::previousCount() const {
+	return int(_previous.size());
+}
+
+bool Manifest::restore(
+		Key key,
+		const QString &relativePath,
+		Stats *stats) {
+	const auto i = _previous.find(key);
+	if (i == end(_previous)) {
+		return false;
+	}
+	const auto &entry = i->second;
+	auto source = QFile(entry.path);
+	if (source.size() != entry.size || !source.open(QIODevice::ReadOnly)) {
+		return false;
+	}
+	const auto path = _folder + relativePath;
+	auto valid = false;
+	{
+		auto target = File(path, nullptr);
+		auto checksum = QCryptographicHash(QCryptographicHash::Md5);
+		valid = target.writeBlock(QByteArray()).isSuccess();
+		while (valid && !source.atEnd()) {
+			const auto block = source.read(kCopyBlockSize);
+			valid = !block.isEmpty() && target.writeBlock(block).isSuccess();
+			checksum.addData(block);
+		}
+		valid = valid
+			&& (target.size() == entry.size)
+			&& (checksum.result() == entry.checksum);
+	}
+	if (!valid) {
+		LOG(("Export Error: Could not reuse '%1'.").arg(entry.path));
+		QFile::remove(path);
+		return false;
+	}
+	if (stats) {
+		stats->incrementFiles();
+		stats->incrementBytes(entry.size);
+	}
+	append(key, relativePath, entry.size, entry.checksum);
+	return true;
+}
+
+void Manifest::append(
+		Key key,
+		const QString &relativePath,
+		int64 size,
+		const QByteArray &checksum) {
+	if (_failed
+		|| !key.id
+		|| checksum.size() != kChecksumSize
+		|| relativePath.contains('\n')) {
+		return;
+	} else if (!_file) {
+		_file.emplace(_folder + kFileName);
+		if (!_file->open(QIODevice::Append)) {
+			LOG(("Export Error: Could not open '%1'."
+				).arg(_file->fileName()));
+			_failed = true;
+			return;
+		} else if (!_file->size()) {
+			_file->write(QByteArray(kHeader) + '\n');
+		}
+	}
+	const auto line = QString("%1 %2 %3 %4 %5\n"
+	).arg(key.type
+	).arg(key.id
+	).arg(size
+	).arg(QString::fromLatin1(checksum.toHex())
+	).arg(relativePath);
+	_file->write(line.toUtf8());
+	_file->flush();
+}
+
+void Manifest::loadPrevious() {
+	const auto self = QDir(_folder).absolutePath();
+	auto parent = QDir(self);
+	if (!parent.cdUp()) {
+		return;
+	}
+	const auto list = parent.entryInfoList(
+		QDir::Dirs | QDir::NoDotAndDotDot,
+		QDir::Name);
+	for (const auto &info : list) {
+		const auto path = info.absoluteFilePath();
+		if (path != self && QFile::exists(path + '/' + kFileName)) {
+			loadFrom(path + '/');
+		}
+	}
+}
+
+void Manifest::loadFrom(const QString &folder) {
+	auto file = QFile(folder + kFileName);
+	if (!file.open(QIODevice::ReadOnly)
+		|| file.readLine().trimmed() != kHeader) {
+		return;
+	}
+	while (!file.atEnd()) {
+		const auto line = QString::fromUtf8(file.readLine());
+		if (!line.endsWith('\n')) {
+			break; // Interrupted while writing this line.
+		}
+		const auto fields = line.chopped(1).split(' ');
+		if (fields.size() < 5) {
+			continue;
+		}
+		auto typeOk = false, idOk = false, sizeOk = false;
+		const auto key = Key{
+			.type = fields[0].toULongLong(&typeOk),
+			.id = fields[1].toULongLong(&idOk),
+		};
+		const auto size = fields[2].toLongLong(&sizeOk);
+		const auto checksum = QByteArray::fromHex(fields[3].toLatin1());
+		const auto relativePath = fields.mid(4).join(' ');
+		if (!typeOk
+			|| !idOk
+			|| !key.id
+			|| !sizeOk
+			|| size < 0
+			|| checksum.size() != kChecksumSize
+			|| relativePath.isEmpty()
+			|| QDir::isAbsolutePath(relativePath)
+			|| relativePath.contains(u".."_q)) {
+			continue;
+		}
+		_previous[key] = Entry{
+			.path = folder + relativePath,
+			.size = size,
+			.checksum = checksum,
+		};
+	}
+}
+
+} // namespace Output
+} // namespace Export
@@ -0,0 +1,67 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include <QtCore/QFile>
+#include <QtCore/QString>
+#include <QtCore/QByteArray>
+
+namespace Export {
+namespace Output {
+
+class Stats;
+
+// List of downloaded files, appended to the export folder as they are
+// written, so that it is valid even if the export was interrupted.
+//
+// Manifests of previous exports in the neighbour folders are read on
+// start and their files are copied instead of downloading them again.
+class Manifest final {
+public:
+	struct Key {
+		uint64 type = 0;
+		uint64 id = 0;
+
+		friend inline auto operator<=>(Key, Key) = default;
+	};
+
+	explicit Manifest(const QString &folder);
+
+	[[nodiscard]] int previousCount() const;
+
+	// Copies a file from a previous export if it is still there unchanged.
+	[[nodiscard]] bool restore(
+		Key key,
+		const QString &relativePath,
+		Stats *stats);
+
+	void append(
+		Key key,
+		const QString &relativePath,
+		int64 size,
+		const QByteArray &checksum);
+
+private:
+	struct Entry {
+		QString path;
+		int64 size = 0;
+		QByteArray checksum;
+	};
+
+	void loadPrevious();
+	void loadFrom(const QString &folder);
+
+	QString _folder;
+	std::map<Key, Entry> _previous;
+	std::optional<QFile> _file;
+	bool _failed = false;
+
+};
+
+} // namespace Output
+} // namespace Export
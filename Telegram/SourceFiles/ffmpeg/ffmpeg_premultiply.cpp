@@ -0,0 +1,375 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "ffmpeg/ffmpeg_premultiply.h"
+
+#include <QImage>
+
+#include <array>
+
+#ifdef LIB_FFMPEG_USE_QT_PRIVATE_API
+#include <private/qdrawhelper_p.h>
+#endif // LIB_FFMPEG_USE_QT_PRIVATE_API
+
+#if defined Q_PROCESSOR_X86_64
+#define LIB_FFMPEG_SIMD_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif // _MSC_VER
+#elif defined Q_PROCESSOR_ARM_64 // Q_PROCESSOR_X86_64
+#define LIB_FFMPEG_SIMD_NEON
+#include <arm_neon.h>
+#endif // Q_PROCESSOR_X86_64 || Q_PROCESSOR_ARM_64
+
+#if defined LIB_FFMPEG_SIMD_X86 && !defined _MSC_VER
+#define LIB_FFMPEG_TARGET(features) __attribute__((target(features)))
+#else // LIB_FFMPEG_SIMD_X86 && !_MSC_VER
+#define LIB_FFMPEG_TARGET(features)
+#endif // LIB_FFMPEG_SIMD_X86 && !_MSC_VER
+
+namespace FFmpeg {
+namespace {
+
+using LineMethod = void(*)(uchar *dst, const uchar *src, int intsCount);
+
+struct LineMethods {
+	LineMethod premultiply = nullptr;
+	LineMethod unpremultiply = nullptr;
+};
+
+// Same as qt_inv_premul_factor, (c * factor + 0x8000) >> 16 == c * 255 / a.
+constexpr auto kInvPremultiplyFactor = [] {
+	auto result = std::array<uint32, 256>();
+	for (auto i = 1; i != 256; ++i) {
+		result[i] = 0x00FF00FFU / uint32(i);
+	}
+	return result;
+}();
+
+void UnPremultiplyLineScalar(uchar *dst, const uchar *src, int intsCount) {
+	[[maybe_unused]] const auto udst = reinterpret_cast<uint*>(dst);
+	const auto usrc = reinterpret_cast<const uint*>(src);
+
+#ifndef LIB_FFMPEG_USE_QT_PRIVATE_API
+	for (auto i = 0; i != intsCount; ++i) {
+		udst[i] = qUnpremultiply(usrc[i]);
+	}
+#else // !LIB_FFMPEG_USE_QT_PRIVATE_API
+	static const auto layout = &qPixelLayouts[QImage::Format_ARGB32];
+	layout->storeFromARGB32PM(dst, usrc, 0, intsCount, nullptr, nullptr);
+#endif // LIB_FFMPEG_USE_QT_PRIVATE_API
+}
+
+void PremultiplyLineScalar(uchar *dst, const uchar *src, int intsCount) {
+	const auto udst = reinterpret_cast<uint*>(dst);
+	[[maybe_unused]] const auto usrc = reinterpret_cast<const uint*>(src);
+
+#ifndef LIB_FFMPEG_USE_QT_PRIVATE_API
+	for (auto i = 0; i != intsCount; ++i) {
+		udst[i] = qPremultiply(usrc[i]);
+	}
+#else // !LIB_FFMPEG_USE_QT_PRIVATE_API
+	static const auto layout = &qPixelLayouts[QImage::Format_ARGB32];
+	layout->fetchToARGB32PM(udst, src, 0, intsCount, nullptr, nullptr);
+#endif // LIB_FFMPEG_USE_QT_PRIVATE_API
+}
+
+#ifdef LIB_FFMPEG_SIMD_X86
+
+// Pixels are 0xAARRGGBB, so in memory each of them is B, G, R, A bytes.
+// Premultiplication matches qPremultiply exactly:
+// c * a / 255 is computed as (v + (v >> 8) + 0x80) >> 8, where v = c * a.
+
+[[nodiscard]] inline __m128i PremultiplyWordsSse2(__m128i words) {
+	const auto alpha = _mm_shufflehi_epi16(
+		_mm_shufflelo_epi16(words, _MM_SHUFFLE(3, 3, 3, 3)),
+		_MM_SHUFFLE(3, 3, 3, 3));
+	const auto value = _mm_mullo_epi16(words, alpha);
+	return _mm_srli_epi16(
+		_mm_add_epi16(
+			_mm_add_epi16(value, _mm_srli_epi16(value, 8)),
+			_mm_set1_epi16(0x80)),
+		8);
+}
+
+void PremultiplyLineSse2(uchar *dst, const uchar *src, int intsCount) {
+	const auto zero = _mm_setzero_si128();
+	const auto alphaMask = _mm_set1_epi32(int(0xFF000000U));
+	auto i = 0;
+	for (; i + 4 <= intsCount; i += 4) {
+		const auto pixels = _mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(src + i * 4));
+		const auto result = _mm_packus_epi16(
+			PremultiplyWordsSse2(_mm_unpacklo_epi8(pixels, zero)),
+			PremultiplyWordsSse2(_mm_unpackhi_epi8(pixels, zero)));
+		_mm_storeu_si128(
+			reinterpret_cast<__m128i*>(dst + i * 4),
+			_mm_or_si128(
+				_mm_andnot_si128(alphaMask, result),
+				_mm_and_si128(pixels, alphaMask)));
+	}
+	PremultiplyLineScalar(dst + i * 4, src + i * 4, intsCount - i);
+}
+
+template <int Shift>
+LIB_FFMPEG_TARGET("sse4.1")
+[[nodiscard]] inline __m128i UnPremultiplyChannelSse41(
+		__m128i pixels,
+		__m128i factor) {
+	const auto channel = _mm_and_si128(
+		_mm_srli_epi32(pixels, Shift),
+		_mm_set1_epi32(0xFF));
+	const auto value = _mm_srli_epi32(
+		_mm_add_epi32(
+			_mm_mullo_epi32(channel, factor),
+			_mm_set1_epi32(0x8000)),
+		16);
+	return _mm_slli_epi32(
+		_mm_min_epu32(value, _mm_set1_epi32(0xFF)),
+		Shift);
+}
+
+LIB_FFMPEG_TARGET("sse4.1")
+void UnPremultiplyLineSse41(uchar *dst, const uchar *src, int intsCount) {
+	const auto alphaMask = _mm_set1_epi32(int(0xFF000000U));
+	const auto opaque = _mm_set1_epi32(0xFF);
+	auto i = 0;
+	for (; i + 4 <= intsCount; i += 4) {
+		const auto from = src + i * 4;
+		const auto pixels = _mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(from));
+		const auto factor = _mm_setr_epi32(
+			int(kInvPremultiplyFactor[from[3]]),
+			int(kInvPremultiplyFactor[from[7]]),
+			int(kInvPremultiplyFactor[from[11]]),
+			int(kInvPremultiplyFactor[from[15]]));
+		const auto result = _mm_or_si128(
+			_mm_or_si128(
+				_mm_and_si128(pixels, alphaMask),
+				UnPremultiplyChannelSse41<0>(pixels, factor)),
+			_mm_or_si128(
+				UnPremultiplyChannelSse41<8>(pixels, factor),
+				UnPremultiplyChannelSse41<16>(pixels, factor)));
+
+		// Like qUnpremultiply, leave fully opaque pixels untouched.
+		const auto isOpaque = _mm_cmpeq_epi32(
+			_mm_srli_epi32(pixels, 24),
+			opaque);
+		_mm_storeu_si128(
+			reinterpret_cast<__m128i*>(dst + i * 4),
+			_mm_blendv_epi8(result, pixels, isOpaque));
+	}
+	UnPremultiplyLineScalar(dst + i * 4, src + i * 4, intsCount - i);
+}
+
+LIB_FFMPEG_TARGET("avx2")
+[[nodiscard]] inline __m256i PremultiplyWordsAvx2(__m256i words) {
+	const auto alpha = _mm256_shufflehi_epi16(
+		_mm256_shufflelo_epi16(words, _MM_SHUFFLE(3, 3, 3, 3)),
+		_MM_SHUFFLE(3, 3, 3, 3));
+	const auto value = _mm256_mullo_epi16(words, alpha);
+	return _mm256_srli_epi16(
+		_mm256_add_epi16(
+			_mm256_add_epi16(value, _mm256_srli_epi16(value, 8)),
+			_mm256_set1_epi16(0x80)),
+		8);
+}
+
+LIB_FFMPEG_TARGET("avx2")
+void PremultiplyLineAvx2(uchar *dst, const uchar *src, int intsCount) {
+	const auto zero = _mm256_setzero_si256();
+	const auto alphaMask = _mm256_set1_epi32(int(0xFF000000U));
+	auto i = 0;
+	for (; i + 8 <= intsCount; i += 8) {
+		const auto pixels = _mm256_loadu_si256(
+			reinterpret_cast<const __m256i*>(src + i * 4));
+
+		// Unpack and pack work inside 128 bit lanes, so the order is kept.
+		const auto result = _mm256_packus_epi16(
+			PremultiplyWordsAvx2(_mm256_unpacklo_epi8(pixels, zero)),
+			PremultiplyWordsAvx2(_mm256_unpackhi_epi8(pixels, zero)));
+		_mm256_storeu_si256(
+			reinterpret_cast<__m256i*>(dst + i * 4),
+			_mm256_or_si256(
+				_mm256_andnot_si256(alphaMask, result),
+				_mm256_and_si256(pixels, alphaMask)));
+	}
+	PremultiplyLineSse2(dst + i * 4, src + i * 4, intsCount - i);
+}
+
+template <int Shift>
+LIB_FFMPEG_TARGET("avx2")
+[[nodiscard]] inline __m256i UnPremultiplyChannelAvx2(
+		__m256i pixels,
+		__m256i factor) {
+	const auto channel = _mm256_and_si256(
+		_mm256_srli_epi32(pixels, Shift),
+		_mm256_set1_epi32(0xFF));
+	const auto value = _mm256_srli_epi32(
+		_mm256_add_epi32(
+			_mm256_mullo_epi32(channel, factor),
+			_mm256_set1_epi32(0x8000)),
+		16);
+	return _mm256_slli_epi32(
+		_mm256_min_epu32(value, _mm256_set1_epi32(0xFF)),
+		Shift);
+}
+
+LIB_FFMPEG_TARGET("avx2")
+void UnPremultiplyLineAvx2(uchar *dst, const uchar *src, int intsCount) {
+	const auto alphaMask = _mm256_set1_epi32(int(0xFF000000U));
+	const auto opaque = _mm256_set1_epi32(0xFF);
+	const auto factors = reinterpret_cast<const int*>(
+		kInvPremultiplyFactor.data());
+	auto i = 0;
+	for (; i + 8 <= intsCount; i += 8) {
+		const auto pixels = _mm256_loadu_si256(
+			reinterpret_cast<const __m256i*>(src + i * 4));
+		const auto alpha = _mm256_srli_epi32(pixels, 24);
+		const auto factor = _mm256_i32gather_epi32(factors, alpha, 4);
+		const auto result = _mm256_or_si256(
+			_mm256_or_si256(
+				_mm256_and_si256(pixels, alphaMask),
+				UnPremultiplyChannelAvx2<0>(pixels, factor)),
+			_mm256_or_si256(
+				UnPremultiplyChannelAvx2<8>(pixels, factor),
+				UnPremultiplyChannelAvx2<16>(pixels, factor)));
+		_mm256_storeu_si256(
+			reinterpret_cast<__m256i*>(dst + i * 4),
+			_mm256_blendv_epi8(
+				result,
+				pixels,
+				_mm256_cmpeq_epi32(alpha, opaque)));
+	}
+	UnPremultiplyLineSse41(dst + i * 4, src + i * 4, intsCount - i);
+}
+
+#ifdef _MSC_VER
+
+[[nodiscard]] bool HasSse41() {
+	int info[4] = { 0 };
+	__cpuid(info, 1);
+	return (info[2] & (1 << 19)) != 0;
+}
+
+[[nodiscard]] bool HasAvx2() {
+	int info[4] = { 0 };
+	__cpuid(info, 1);
+	const auto osxsave = (info[2] & (1 << 27)) != 0;
+	const auto avx = (info[2] & (1 << 28)) != 0;
+	if (!osxsave || !avx || (_xgetbv(0) & 0x06) != 0x06) {
+		return false;
+	}
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+}
+
+#else // _MSC_VER
+
+[[nodiscard]] bool HasSse41() {
+	return __builtin_cpu_supports("sse4.1");
+}
+
+[[nodiscard]] bool HasAvx2() {
+	return __builtin_cpu_supports("avx2");
+}
+
+#endif // _MSC_VER
+
+#elif defined LIB_FFMPEG_SIMD_NEON // LIB_FFMPEG_SIMD_X86
+
+// NEON is always available on 64 bit ARM, no runtime check required.
+
+void PremultiplyLineNeon(uchar *dst, const uchar *src, int intsCount) {
+	auto i = 0;
+	for (; i + 8 <= intsCount; i += 8) {
+		auto pixels = vld4_u8(src + i * 4);
+		const auto alpha = pixels.val[3];
+		for (auto channel = 0; channel != 3; ++channel) {
+			const auto value = vmull_u8(pixels.val[channel], alpha);
+			pixels.val[channel] = vraddhn_u16(value, vshrq_n_u16(value, 8));
+		}
+		vst4_u8(dst + i * 4, pixels);
+	}
+	PremultiplyLineScalar(dst + i * 4, src + i * 4, intsCount - i);
+}
+
+void UnPremultiplyLineNeon(uchar *dst, const uchar *src, int intsCount) {
+	const auto half = vdupq_n_u32(0x8000);
+	uint32 factors[8] = { 0 };
+	auto i = 0;
+	for (; i + 8 <= intsCount; i += 8) {
+		const auto from = src + i * 4;
+		auto pixels = vld4_u8(from);
+		for (auto k = 0; k != 8; ++k) {
+			factors[k] = kInvPremultiplyFactor[from[k * 4 + 3]];
+		}
+		const auto factorLow = vld1q_u32(factors);
+		const auto factorHigh = vld1q_u32(factors + 4);
+
+		// Like qUnpremultiply, leave fully opaque pixels untouched.
+		const auto isOpaque = vceq_u8(pixels.val[3], vdup_n_u8(0xFF));
+		for (auto channel = 0; channel != 3; ++channel) {
+			const auto wide = vmovl_u8(pixels.val[channel]);
+			const auto low = vmulq_u32(
+				vmovl_u16(vget_low_u16(wide)),
+				factorLow);
+			const auto high = vmulq_u32(
+				vmovl_u16(vget_high_u16(wide)),
+				factorHigh);
+			const auto value = vcombine_u16(
+				vaddhn_u32(low, half),
+				vaddhn_u32(high, half));
+			pixels.val[channel] = vbsl_u8(
+				isOpaque,
+				pixels.val[channel],
+				vqmovn_u16(value));
+		}
+		vst4_u8(dst + i * 4, pixels);
+	}
+	UnPremultiplyLineScalar(dst + i * 4, src + i * 4, intsCount - i);
+}
+
+#endif // LIB_FFMPEG_SIMD_X86 || LIB_FFMPEG_SIMD_NEON
+
+[[nodiscard]] LineMethods ChooseLineMethods() {
+	auto result = LineMethods{
+		.premultiply = PremultiplyLineScalar,
+		.unpremultiply = UnPremultiplyLineScalar,
+	};
+#if defined LIB_FFMPEG_SIMD_X86
+	result.premultiply = PremultiplyLineSse2;
+	if (HasAvx2()) {
+		result.premultiply = PremultiplyLineAvx2;
+		result.unpremultiply = UnPremultiplyLineAvx2;
+	} else if (HasSse41()) {
+		result.unpremultiply = UnPremultiplyLineSse41;
+	}
+#elif defined LIB_FFMPEG_SIMD_NEON // LIB_FFMPEG_SIMD_X86
+	result.premultiply = PremultiplyLineNeon;
+	result.unpremultiply = UnPremultiplyLineNeon;
+#endif // LIB_FFMPEG_SIMD_X86 || LIB_FFMPEG_SIMD_NEON
+	return result;
+}
+
+[[nodiscard]] const LineMethods &ResolvedLineMethods() {
+	static const auto result = ChooseLineMethods();
+	return result;
+}
+
+} // namespace
+
+void PremultiplyLine(uchar *dst, const uchar *src, int intsCount) {
+	ResolvedLineMethods().premultiply(dst, src, intsCount);
+}
+
+void UnPremultiplyLine(uchar *dst, const uchar *src, int intsCount) {
+	ResolvedLineMethods().unpremultiply(dst, src, intsCount);
+}
+
+} // namespace FFmpeg
@@ -0,0 +1,20 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/basic_types.h"
+
+namespace FFmpeg {
+
+// Convert lines of ARGB32 pixels between premultiplied and straight alpha.
+// The best SIMD implementation for the running CPU is chosen on first use.
+// Both can be used in place, with dst == src.
+void PremultiplyLine(uchar *dst, const uchar *src, int intsCount);
+void UnPremultiplyLine(uchar *dst, const uchar *src, int intsCount);
+
+} // namespace FFmpeg
@@ -15,6 +15,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/history_item.h"
 #include "history/history_item_components.h"
 #include "history/history_item_helpers.h"
+#include "history/history_pool.h"
 #include "history/history_translation.h"
 #include "history/history_unread_things.h"
 #include "core/ui_integration.h"
@@ -62,6 +63,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/storage_facade.h"
 #include "storage/storage_shared_media.h"
 #include "storage/storage_account.h"
+#include "storage/storage_messages_database.h"
 #include "support/support_helper.h"
 #include "ui/image/image.h"
 #include "ui/text/text_options.h"
@@ -78,6 +80,7 @@ namespace {
 
 constexpr auto kNewBlockEachMessage = 50;
 constexpr auto kSkipCloudDraftsFor = TimeId(2);
+constexpr auto kLazyResizeMinViews = 200;
 
 using UpdateFlag = Data::HistoryUpdate::Flag;
 
@@ -1392,6 +1395,7 @@ void History::mainViewRemoved(
 	if (scrollTopItem == view) {
 		getNextScrollTopItem(block, view->indexInBlock());
 	}
+	lazyResizeViewRemoved(block->indexInHistory(), view->indexInBlock());
 }
 
 void History::newItemAdded(not_null<HistoryItem*> item) {
@@ -1507,6 +1511,7 @@ HistoryBlock *History::prepareBlockForAddingItem() {
 		for (auto i = 0, l = int(blocks.size()); i != l; ++i) {
 			blocks[i]->setIndexInHistory(i);
 		}
+		lazyResizeBlockAdded(0);
 		_buildingFrontBlock->block = blocks.front().get();
 		if (_buildingFrontBlock->expectedItemsCount > 0) {
 			_buildingFrontBlock->block->messages.reserve(
@@ -2350,6 +2355,7 @@ not_null<HistoryItem*> History::addNewInTheMiddle(
 		block->messages.begin() + itemIndex,
 		item->createView(_delegateMixin->delegate()));
 	(*it)->attachToBlock(block.get(), itemIndex);
+	lazyResizeViewAdded(blockIndex, itemIndex);
 	if (itemIndex + 1 < block->messages.size()) {
 		for (auto i = itemIndex + 1, l = int(block->messages.size()); i != l; ++i) {
 			block->messages[i]->setIndexInBlock(i);
@@ -3362,6 +3368,10 @@ void History::resizeToWidth(int newWidth) {
 		return;
 	}
 	_flags &= ~(Flag::HasPendingResizedItems | Flag::PendingAllItemsResize);
+	if (request != Request::ResizePending) {
+		_flags &= ~Flag::HasLazyResizedItems;
+		_lazyResizeRange = false;
+	}
 
 	_width = newWidth;
 	int y = 0;
@@ -3372,6 +3382,215 @@ void History::resizeToWidth(int newWidth) {
 	_height = y;
 }
 
+void History::resizeToWidthAround(int newWidth, int top, int bottom) {
+	const auto viewsCount = ranges::accumulate(
+		blocks,
+		0,
+		ranges::plus(),
+		[](const auto &block) { return int(block->messages.size()); });
+	if ((_flags & Flag::PendingAllItemsResize)
+		|| (_width == newWidth)
+		|| !_width
+		|| (viewsCount < kLazyResizeMinViews)) {
+		resizeToWidth(newWidth);
+		return;
+	}
+	_flags &= ~Flag::HasPendingResizedItems;
+	_flags |= Flag::HasLazyResizedItems;
+	_lazyResizeRange = false;
+
+	_width = newWidth;
+	int y = 0;
+	for (const auto &block : blocks) {
+		const auto wasY = block->y();
+		block->setY(y);
+		y += block->resizeGetHeightAround(
+			newWidth,
+			top - wasY,
+			bottom - wasY);
+	}
+	_height = y;
+}
+
+bool History::hasLazyResizedItems() const {
+	return _flags & Flag::HasLazyResizedItems;
+}
+
+bool History::resizeLazyItems(crl::time deadline, int around) {
+	if (!hasLazyResizedItems()) {
+		return true;
+	} else if (isEmpty()) {
+		_flags &= ~Flag::HasLazyResizedItems;
+		_lazyResizeRange = false;
+		return true;
+	}
+	const auto anchor = lazyResizePositionAt(around);
+	if (!_lazyResizeRange
+		|| !lazyResizeValid(_lazyResizeUp)
+		|| !lazyResizeValid(_lazyResizeDown)
+		|| anchor < _lazyResizeUp
+		|| _lazyResizeDown < anchor) {
+		_lazyResizeRange = true;
+		_lazyResizeUp = _lazyResizeDown = anchor;
+		lazyResizeView(anchor);
+	}
+	while (true) {
+		auto up = _lazyResizeUp;
+		auto down = _lazyResizeDown;
+		const auto hasUp = lazyResizePrevious(up);
+		const auto hasDown = lazyResizeNext(down);
+		if (!hasUp && !hasDown) {
+			break;
+		}
+		if (hasDown) {
+			lazyResizeView(_lazyResizeDown = down);
+		}
+		if (hasUp) {
+			lazyResizeView(_lazyResizeUp = up);
+		}
+		if (crl::now() >= deadline) {
+			// Positions will be updated in resizeToWidth().
+			setHasPendingResizedItems();
+			return false;
+		}
+	}
+	_lazyResizeRange = false;
+	_flags &= ~Flag::HasLazyResizedItems;
+	setHasPendingResizedItems();
+	return true;
+}
+
+bool History::resizeLazyItemsIn(int top, int bottom) {
+	if (!hasLazyResizedItems() || isEmpty()) {
+		return false;
+	}
+	auto changed = false;
+	auto position = lazyResizePositionAt(top);
+	do {
+		const auto &block = blocks[position.block];
+		const auto view = block->messages[position.item].get();
+		if (block->y() + view->y() >= bottom) {
+			break;
+		} else if (lazyResizeView(position)) {
+			changed = true;
+		}
+	} while (lazyResizeNext(position));
+	if (changed) {
+		setHasPendingResizedItems();
+	}
+	return changed;
+}
+
+auto History::lazyResizePositionAt(int y) const -> LazyResizePosition {
+	Expects(!blocks.empty());
+
+	const auto blockAfter = ranges::upper_bound(
+		blocks,
+		y,
+		ranges::less(),
+		[](const auto &block) { return block->y(); });
+	const auto block = std::max(int(blockAfter - begin(blocks)) - 1, 0);
+	const auto &messages = blocks[block]->messages;
+	const auto itemAfter = ranges::upper_bound(
+		messages,
+		y - blocks[block]->y(),
+		ranges::less(),
+		[](const auto &view) { return view->y(); });
+	const auto item = std::max(int(itemAfter - begin(messages)) - 1, 0);
+	return { block, item };
+}
+
+bool History::lazyResizeValid(LazyResizePosition position) const {
+	return (position.block < int(blocks.size()))
+		&& (position.item < int(blocks[position.block]->messages.size()));
+}
+
+bool History::lazyResizeNext(LazyResizePosition &position) const {
+	if (position.item + 1
+		< int(blocks[position.block]->messages.size())) {
+		++position.item;
+	} else if (position.block + 1 < int(blocks.size())) {
+		++position.block;
+		position.item = 0;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+bool History::lazyResizePrevious(LazyResizePosition &position) const {
+	if (position.item > 0) {
+		--position.item;
+	} else if (position.block > 0) {
+		--position.block;
+		position.item = int(blocks[position.block]->messages.size()) - 1;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+// Views added or removed while the range is being laid out shift the
+// positions, so the range is kept pointing to the same views. New views
+// are never waiting for a lazy resize, so they may be inside the range.
+void History::lazyResizeBlockAdded(int blockIndex) {
+	if (!_lazyResizeRange) {
+		return;
+	}
+	for (const auto position : { &_lazyResizeUp, &_lazyResizeDown }) {
+		if (position->block >= blockIndex) {
+			++position->block;
+		}
+	}
+}
+
+void History::lazyResizeViewAdded(int blockIndex, int itemIndex) {
+	if (!_lazyResizeRange) {
+		return;
+	}
+	for (const auto position : { &_lazyResizeUp, &_lazyResizeDown }) {
+		if (position->block == blockIndex && position->item >= itemIndex) {
+			++position->item;
+		}
+	}
+}
+
+void History::lazyResizeViewRemoved(int blockIndex, int itemIndex) {
+	if (!_lazyResizeRange) {
+		return;
+	}
+	const auto removed = LazyResizePosition{ blockIndex, itemIndex };
+	if (removed == _lazyResizeUp || removed == _lazyResizeDown) {
+		_lazyResizeRange = false;
+		return;
+	}
+	for (const auto position : { &_lazyResizeUp, &_lazyResizeDown }) {
+		if (position->block == blockIndex && position->item > itemIndex) {
+			--position->item;
+		}
+	}
+}
+
+void History::lazyResizeBlockRemoved(int blockIndex) {
+	if (!_lazyResizeRange) {
+		return;
+	}
+	for (const auto position : { &_lazyResizeUp, &_lazyResizeDown }) {
+		if (position->block > blockIndex) {
+			--position->block;
+		}
+	}
+}
+
+bool History::lazyResizeView(LazyResizePosition position) {
+	const auto view = blocks[position.block]->messages[position.item].get();
+	if (!view->pendingLazyResize()) {
+		return false;
+	}
+	view->resizeGetHeight(_width);
+	return true;
+}
+
 void History::forceFullResize() {
 	_width = 0;
 	_flags |= Flag::HasPendingResizedItems;
@@ -3910,10 +4129,12 @@ void History::clear(ClearType type, bool markEmpty) {
 
 	forgetScrollState();
 	blocks.clear();
+	_lazyResizeRange = false;
 	owner().notifyHistoryUnloaded(this);
 	lastKeyboardInited = false;
 	if (type == ClearType::Unload) {
 		_loadedAtTop = _loadedAtBottom = markEmpty;
+		HistoryPool::LogStats();
 	} else {
 		// Leave the 'sending' messages in local messages.
 		auto local = base::flat_set<not_null<HistoryItem*>>();
@@ -3927,6 +4148,9 @@ void History::clear(ClearType type, bool markEmpty) {
 		}
 		clearNotifications();
 		owner().notifyHistoryCleared(this);
+		if (const auto local = owner().localMessages()) {
+			local->removeHistory(peer->id);
+		}
 		if (unreadCountKnown()) {
 			setUnreadCount(0);
 		}
@@ -4005,6 +4229,7 @@ void History::removeBlock(not_null<HistoryBlock*> block) {
 
 	int index = block->indexInHistory();
 	blocks.erase(blocks.begin() + index);
+	lazyResizeBlockRemoved(index);
 	if (index < blocks.size()) {
 		for (int i = index, l = blocks.size(); i < l; ++i) {
 			blocks[i]->setIndexInHistory(i);
@@ -4108,6 +4333,23 @@ int HistoryBlock::resizeGetHeight(int newWidth, ResizeRequest request) {
 	return _height;
 }
 
+int HistoryBlock::resizeGetHeightAround(int newWidth, int top, int bottom) {
+	auto y = 0;
+	for (const auto &message : messages) {
+		const auto wasTop = message->y();
+		const auto wasBottom = wasTop + message->height();
+		message->setY(y);
+		if (wasBottom > top && wasTop < bottom) {
+			y += message->resizeGetHeight(newWidth);
+		} else {
+			message->setPendingLazyResize();
+			y += message->height();
+		}
+	}
+	_height = y;
+	return _height;
+}
+
 void HistoryBlock::remove(not_null<Element*> view) {
 	Expects(view->block() == this);
 
@@ -274,6 +274,20 @@ public:
 	void forceFullResize();
 	int height() const;
 
+	// On a width change of a long history lays out only views that were
+	// intersecting [top, bottom), others keep their heights as estimates
+	// until they're laid out by resizeLazyItems() in time-sliced batches.
+	void resizeToWidthAround(int newWidth, int top, int bottom);
+	[[nodiscard]] bool hasLazyResizedItems() const;
+
+	// Lays out views outward from the one at the given position.
+	// Returns true if all views were laid out before the deadline.
+	bool resizeLazyItems(crl::time deadline, int around);
+
+	// Lays out views intersecting [top, bottom) right away.
+	// Returns true if any view was laid out, positions are pending then.
+	bool resizeLazyItemsIn(int top, int bottom);
+
 	void itemRemoved(not_null<HistoryItem*> item);
 	void itemVanished(not_null<HistoryItem*> item);
 
@@ -486,14 +500,35 @@ private:
 		HasPinnedMessages = (1 << 6),
 		ResolveChatListMessage = (1 << 7),
 		MonoAndForumUnreadInvalidatePending = (1 << 8),
+		HasLazyResizedItems = (1 << 9),
 	};
 	using Flags = base::flags<Flag>;
 	friend inline constexpr auto is_flag_type(Flag) {
 		return true;
 	};
 
+	struct LazyResizePosition {
+		int block = 0;
+		int item = 0;
+
+		friend inline auto operator<=>(
+			LazyResizePosition,
+			LazyResizePosition) = default;
+	};
+
 	void cacheTopPromoted(bool promoted);
 
+	[[nodiscard]] LazyResizePosition lazyResizePositionAt(int y) const;
+	[[nodiscard]] bool lazyResizeValid(LazyResizePosition position) const;
+	[[nodiscard]] bool lazyResizeNext(LazyResizePosition &position) const;
+	[[nodiscard]] bool lazyResizePrevious(
+		LazyResizePosition &position) const;
+	bool lazyResizeView(LazyResizePosition position);
+	void lazyResizeBlockAdded(int blockIndex);
+	void lazyResizeViewAdded(int blockIndex, int itemIndex);
+	void lazyResizeViewRemoved(int blockIndex, int itemIndex);
+	void lazyResizeBlockRemoved(int blockIndex);
+
 	// when this item is destroyed scrollTopItem just points to the next one
 	// and scrollTopOffset remains the same
 	// if we are at the bottom of the window scrollTopItem == nullptr and
@@ -620,6 +655,12 @@ private:
 	Flags _flags = 0;
 	int _width = 0;
 	int _height = 0;
+
+	// Views in [_lazyResizeUp, _lazyResizeDown] are already laid out.
+	LazyResizePosition _lazyResizeUp;
+	LazyResizePosition _lazyResizeDown;
+	bool _lazyResizeRange = false;
+
 	Element *_unreadBarView = nullptr;
 	Element *_firstUnreadView = nullptr;
 	HistoryItem *_joinedMessage = nullptr;
@@ -691,6 +732,7 @@ public:
 	void refreshView(not_null<Element*> view);
 
 	int resizeGetHeight(int newWidth, ResizeRequest request);
+	int resizeGetHeightAround(int newWidth, int top, int bottom);
 	int y() const {
 		return _y;
 	}
@@ -114,6 +114,9 @@ namespace {
 constexpr auto kScrollDateHideTimeout = 1000;
 constexpr auto kUnloadHeavyPartsPages = 2;
 constexpr auto kClearUserpicsAfter = 50;
+constexpr auto kLazyResizeMarginPages = 2;
+constexpr auto kLazyResizeSliceDuration = crl::time(8);
+constexpr auto kLazyResizeSliceInterval = crl::time(16);
 
 // Helper binary search for an item in a list that is not completely
 // above the given top of the visible area or below the given bottom of the visible area
@@ -332,7 +335,8 @@ HistoryInner::HistoryInner(
 , _touchSelectTimer([=] { onTouchSelect(); })
 , _touchScrollTimer([=] { onTouchScrollTimer(); })
 , _scrollDateCheck([this] { scrollDateCheck(); })
-, _scrollDateHideTimer([this] { scrollDateHideByTimer(); }) {
+, _scrollDateHideTimer([this] { scrollDateHideByTimer(); })
+, _lazyResizeTimer([=] { resizeLazyItems(); }) {
 	_history->delegateMixin()->setCurrent(this);
 	if (_migrated) {
 		_migrated->delegateMixin()->setCurrent(this);
@@ -1078,6 +1082,10 @@ void HistoryInner::paintEvent(QPaintEvent *e) {
 	if (_controller->contentOverlapped(this, e)
 		|| hasPendingResizedItems()) {
 		return;
+	} else if (resizeVisibleLazyItems()) {
+		// Don't paint views without a layout, recount positions first.
+		InvokeQueued(this, [=] { _widget->handlePendingHistoryUpdate(); });
+		return;
 	} else if (_recountedAfterPendingResizedItems) {
 		_recountedAfterPendingResizedItems = false;
 		mouseActionUpdate();
@@ -3513,9 +3521,24 @@ void HistoryInner::recountHistoryGeometry(bool initial) {
 
 	updateBotInfo(false);
 
-	_history->resizeToWidth(_contentWidth);
+	// Lay out the visible part first, the rest is done in resizeLazyItems.
+	const auto margin = visibleHeight * kLazyResizeMarginPages;
+	const auto layoutTop = _visibleAreaTop - margin;
+	const auto layoutBottom = _visibleAreaBottom + margin;
+	const auto historyShift = historyTop();
+	const auto migratedShift = migratedTop();
+	_history->resizeToWidthAround(
+		_contentWidth,
+		layoutTop - historyShift,
+		layoutBottom - historyShift);
 	if (_migrated) {
-		_migrated->resizeToWidth(_contentWidth);
+		_migrated->resizeToWidthAround(
+			_contentWidth,
+			layoutTop - migratedShift,
+			layoutBottom - migratedShift);
+	}
+	if (hasLazyResizedItems() && !_lazyResizeTimer.isActive()) {
+		_lazyResizeTimer.callOnce(kLazyResizeSliceInterval);
 	}
 
 	// With migrated history we perhaps do not need to display
@@ -3588,6 +3611,10 @@ void HistoryInner::visibleAreaUpdated(int top, int bottom) {
 	// if history has pending resize events we should not update scrollTopItem
 	if (hasPendingResizedItems()) {
 		return;
+	} else if (resizeVisibleLazyItems()) {
+		// This will call visibleAreaUpdated() again with new positions.
+		_widget->handlePendingHistoryUpdate();
+		return;
 	}
 
 	if (bottom >= _historyPaddingTop + historyHeight() + st::historyPaddingBottom) {
@@ -4824,6 +4851,52 @@ bool HistoryInner::hasPendingResizedItems() const {
 		|| (_migrated && _migrated->hasPendingResizedItems());
 }
 
+bool HistoryInner::hasLazyResizedItems() const {
+	return _history->hasLazyResizedItems()
+		|| (_migrated && _migrated->hasLazyResizedItems());
+}
+
+bool HistoryInner::resizeVisibleLazyItems() {
+	const auto top = _visibleAreaTop;
+	const auto bottom = _visibleAreaBottom;
+	const auto historyShift = historyTop();
+	const auto migratedShift = migratedTop();
+	const auto history = (historyShift >= 0)
+		&& _history->resizeLazyItemsIn(
+			top - historyShift,
+			bottom - historyShift);
+	const auto migrated = _migrated
+		&& (migratedShift >= 0)
+		&& _migrated->resizeLazyItemsIn(
+			top - migratedShift,
+			bottom - migratedShift);
+	return history || migrated;
+}
+
+void HistoryInner::resizeLazyItems() {
+	const auto deadline = crl::now() + kLazyResizeSliceDuration;
+	const auto around = (_visibleAreaTop + _visibleAreaBottom) / 2;
+	const auto historyShift = historyTop();
+	const auto migratedShift = migratedTop();
+	const auto migratedFirst = _migrated
+		&& (migratedShift >= 0)
+		&& (historyShift < 0 || around < historyShift);
+	if (migratedFirst) {
+		if (_migrated->resizeLazyItems(deadline, around - migratedShift)) {
+			_history->resizeLazyItems(deadline, around - historyShift);
+		}
+	} else if (_history->resizeLazyItems(deadline, around - historyShift)
+		&& _migrated) {
+		_migrated->resizeLazyItems(deadline, around - migratedShift);
+	}
+
+	// Positions are updated keeping the scroll anchored to scrollTopItem.
+	_widget->handlePendingHistoryUpdate();
+	if (hasLazyResizedItems()) {
+		_lazyResizeTimer.callOnce(kLazyResizeSliceInterval);
+	}
+}
+
 void HistoryInner::deleteAsGroup(FullMsgId itemId) {
 	if (const auto item = session().data().message(itemId)) {
 		const auto group = session().data().groups().find(item);
@@ -17,6 +17,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/view/media/history_view_media_grouped.h"
 #include "history/history_item_components.h"
 #include "history/history_item_helpers.h"
+#include "history/history_pool.h"
 #include "history/history_unread_things.h"
 #include "history/history.h"
 #include "iv/iv_data.h"
@@ -75,9 +76,18 @@ namespace {
 
 constexpr auto kNotificationTextLimit = 255;
 constexpr auto kPinnedMessageTextLimit = 16;
+constexpr auto kItemsInPoolChunk = 256;
 
 using ItemPreview = HistoryView::ItemPreview;
 
+[[nodiscard]] HistoryPool &ItemsPool() {
+	static const auto result = new HistoryPool(
+		"items",
+		sizeof(HistoryItem),
+		kItemsInPoolChunk);
+	return *result;
+}
+
 template <typename T>
 [[nodiscard]] PreparedServiceText PrepareEmptyText(const T &) {
 	return PreparedServiceText();
@@ -799,6 +809,16 @@ HistoryItem::~HistoryItem() {
 	applyTTL(0);
 }
 
+void *HistoryItem::operator new(std::size_t size) {
+	Expects(size == sizeof(HistoryItem));
+
+	return ItemsPool().allocate();
+}
+
+void HistoryItem::operator delete(void *pointer) {
+	ItemsPool().deallocate(pointer);
+}
+
 TimeId HistoryItem::date() const {
 	return _date;
 }
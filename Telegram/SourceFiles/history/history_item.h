@@ -164,6 +164,10 @@ public:
 		not_null<GameData*> game);
 	~HistoryItem();
 
+	// Items are allocated from a pool, see history_pool.h.
+	static void *operator new(std::size_t size);
+	static void operator delete(void *pointer);
+
 	struct Destroyer {
 		void operator()(HistoryItem *value);
 	};
@@ -0,0 +1,139 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "history/history_pool.h"
+
+namespace {
+
+// Keep one empty chunk to avoid reallocating it on load / unload edges.
+constexpr auto kKeepEmptyChunks = 1;
+
+[[nodiscard]] std::size_t ComputeBlockSize(std::size_t size) {
+	constexpr auto kAlign = alignof(std::max_align_t);
+	const auto result = std::max(size, sizeof(void*));
+	return ((result + kAlign - 1) / kAlign) * kAlign;
+}
+
+[[nodiscard]] std::vector<not_null<HistoryPool*>> &Pools() {
+	static auto result = std::vector<not_null<HistoryPool*>>();
+	return result;
+}
+
+} // namespace
+
+HistoryPool::HistoryPool(
+	const char *name,
+	std::size_t blockSize,
+	int blocksInChunk)
+: _name(name)
+, _blockSize(ComputeBlockSize(blockSize))
+, _blocksInChunk(blocksInChunk)
+, _thread(std::this_thread::get_id()) {
+	Expects(blocksInChunk > 0);
+
+	Pools().push_back(this);
+}
+
+void *HistoryPool::allocate() {
+	Expects(std::this_thread::get_id() == _thread);
+
+	if (_available.empty()) {
+		addChunk();
+	}
+	const auto chunk = _available.back();
+	if (!chunk->used) {
+		--_emptyChunks;
+	}
+	auto result = chunk->free;
+	if (result) {
+		chunk->free = *static_cast<void**>(result);
+		++_stats.recycled;
+	} else {
+		Assert(chunk->initialized < _blocksInChunk);
+		result = chunk->data.get() + (chunk->initialized++ * _blockSize);
+	}
+	if (++chunk->used == _blocksInChunk) {
+		chunk->available = false;
+		_available.pop_back();
+	}
+	++_stats.live;
+	++_stats.allocated;
+	return result;
+}
+
+void HistoryPool::deallocate(void *block) {
+	Expects(std::this_thread::get_id() == _thread);
+
+	if (!block) {
+		return;
+	}
+	--_stats.live;
+	const auto address = static_cast<char*>(block);
+	auto i = _chunks.upper_bound(address);
+	Assert(i != begin(_chunks));
+	--i;
+	Assert(address < i->first + (_blockSize * _blocksInChunk));
+
+	const auto chunk = &i->second;
+	*static_cast<void**>(block) = chunk->free;
+	chunk->free = block;
+	if (!chunk->available) {
+		chunk->available = true;
+		_available.push_back(chunk);
+	}
+	if (!--chunk->used) {
+		if (_emptyChunks < kKeepEmptyChunks) {
+			++_emptyChunks;
+		} else {
+			releaseChunk(i);
+		}
+	}
+}
+
+HistoryPool::Stats HistoryPool::stats() const {
+	auto result = _stats;
+	result.chunks = int(_chunks.size());
+	return result;
+}
+
+void HistoryPool::LogStats() {
+	if (!Logs::DebugEnabled()) {
+		return;
+	}
+	for (const auto pool : Pools()) {
+		Expects(std::this_thread::get_id() == pool->_thread);
+
+		const auto stats = pool->stats();
+		DEBUG_LOG(("History Pool: %1, "
+			"live %2, chunks %3, allocated %4, recycled %5."
+			).arg(pool->_name
+			).arg(stats.live
+			).arg(stats.chunks
+			).arg(stats.allocated
+			).arg(stats.recycled));
+	}
+}
+
+void HistoryPool::addChunk() {
+	auto data = std::unique_ptr<char[]>(
+		new char[_blockSize * _blocksInChunk]);
+	const auto address = data.get();
+	auto &chunk = _chunks.emplace(address, Chunk()).first->second;
+	chunk.data = std::move(data);
+	chunk.available = true;
+	_available.push_back(&chunk);
+	++_emptyChunks;
+}
+
+void HistoryPool::releaseChunk(std::map<char*, Chunk>::iterator i) {
+	Expects(!i->second.used);
+
+	_available.erase(
+		ranges::remove(_available, &i->second),
+		end(_available));
+	_chunks.erase(i);
+}
@@ -0,0 +1,61 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include <thread>
+
+// Pool of same size blocks, allocated by chunks, main thread only
+// (checked against the thread that created the pool on first use).
+// Pools are never destroyed, so that objects may outlive static cleanup.
+//
+// Used by class-specific operator new / delete of the objects that are
+// created and destroyed by thousands when a long history is loaded,
+// scrolled and unloaded, like HistoryItem and HistoryView::Element.
+class HistoryPool final {
+public:
+	HistoryPool(const char *name, std::size_t blockSize, int blocksInChunk);
+	HistoryPool(const HistoryPool &other) = delete;
+	HistoryPool &operator=(const HistoryPool &other) = delete;
+
+	struct Stats {
+		int live = 0; // Blocks allocated right now.
+		int chunks = 0;
+		int64 allocated = 0; // Allocations since the pool was created.
+		int64 recycled = 0; // Allocations reusing a deallocated block.
+	};
+
+	[[nodiscard]] void *allocate();
+	void deallocate(void *block);
+
+	[[nodiscard]] Stats stats() const;
+
+	// Writes stats of all the pools created so far to the debug log.
+	static void LogStats();
+
+private:
+	struct Chunk {
+		std::unique_ptr<char[]> data;
+		void *free = nullptr;
+		int used = 0;
+		int initialized = 0;
+		bool available = false;
+	};
+
+	void addChunk();
+	void releaseChunk(std::map<char*, Chunk>::iterator i);
+
+	const char * const _name = nullptr;
+	const std::size_t _blockSize = 0;
+	const int _blocksInChunk = 0;
+	const std::thread::id _thread;
+	std::map<char*, Chunk> _chunks;
+	std::vector<Chunk*> _available;
+	int _emptyChunks = 0;
+	Stats _stats;
+
+};
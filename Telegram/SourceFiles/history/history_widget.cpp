@@ -139,6 +139,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/storage_account.h"
 #include "storage/file_upload.h"
 #include "storage/storage_media_prepare.h"
+#include "storage/storage_messages_database.h"
 #include "media/audio/media_audio.h"
 #include "media/audio/media_audio_capture.h"
 #include "media/player/media_player_instance.h"
@@ -227,6 +228,22 @@ const auto kPsaAboutPrefix = "cloud_lng_about_psa_";
 	return QString();
 }
 
+[[nodiscard]] PeerId PeerIdFromUser(const MTPUser &user) {
+	return user.match([](const auto &data) {
+		return peerFromUser(data.vid());
+	});
+}
+
+[[nodiscard]] PeerId PeerIdFromChat(const MTPChat &chat) {
+	return chat.match([](const MTPDchannel &data) {
+		return peerFromChannel(data.vid());
+	}, [](const MTPDchannelForbidden &data) {
+		return peerFromChannel(data.vid());
+	}, [](const auto &data) {
+		return peerFromChat(data.vid());
+	});
+}
+
 } // namespace
 
 HistoryWidget::HistoryWidget(
@@ -3028,6 +3045,7 @@ void HistoryWidget::clearAllLoadRequests() {
 		histories.cancelRequest(_firstLoadRequest);
 		_firstLoadRequest = 0;
 	}
+	clearLocalMessages();
 	if (_preloadRequest) {
 		histories.cancelRequest(_preloadRequest);
 		_preloadRequest = 0;
@@ -3784,6 +3802,9 @@ void HistoryWidget::closeCurrent() {
 }
 
 void HistoryWidget::messagesFailed(const MTP::Error &error, int requestId) {
+	if (_firstLoadRequest == requestId) {
+		clearLocalMessages();
+	}
 	if (error.type() == u"CHANNEL_PRIVATE"_q
 		&& _peer->isChannel()
 		&& _peer->asChannel()->invitePeekExpires()) {
@@ -3888,6 +3909,7 @@ void HistoryWidget::messagesReceived(
 			checkActivation();
 		}
 	} else if (_firstLoadRequest == requestId) {
+		clearLocalMessages(histList);
 		if (toMigrated) {
 			_history->clear(History::ClearType::Unload);
 		} else if (_migrated) {
@@ -4037,6 +4059,7 @@ void HistoryWidget::firstLoadMessages() {
 
 	const auto history = from;
 	const auto type = Data::Histories::RequestType::History;
+	const auto atTheEnd = !offsetId && !offset;
 	auto &histories = history->owner().histories();
 	_firstLoadRequest = histories.sendRequest(history, type, [=](
 			Fn<void()> finish) {
@@ -4050,13 +4073,112 @@ void HistoryWidget::firstLoadMessages() {
 			MTP_int(minId),
 			MTP_long(historyHash)
 		)).done([=](const MTPmessages_Messages &result) {
+			if (const auto local = history->owner().localMessages()) {
+				if (atTheEnd) {
+					local->putBottomSlice(history->peer->id, result);
+				}
+			}
 			messagesReceived(history->peer, result, _firstLoadRequest);
 			finish();
 		}).fail([=](const MTP::Error &error) {
 			messagesFailed(error, _firstLoadRequest);
 			finish();
-		}).send();
+		}).parseInBackground().send();
 	});
+	if (atTheEnd && history == _history && !_migrated) {
+		showLocalMessages(history);
+	}
+}
+
+void HistoryWidget::showLocalMessages(not_null<History*> history) {
+	const auto local = history->owner().localMessages();
+	if (!local || !history->isEmpty()) {
+		return;
+	}
+	const auto requestId = _firstLoadRequest;
+	local->getBottomSlice(history->peer->id, crl::guard(this, [=](
+			Storage::MessagesDatabaseSlice &&slice) {
+		if (_history != history
+			|| _firstLoadRequest != requestId
+			|| !history->isEmpty()
+			|| slice.messages.isEmpty()) {
+			return;
+		}
+		auto &owner = history->owner();
+
+		// Stored peers are older than the ones we have in memory,
+		// use them only for the peers we know nothing about yet.
+		const auto unknown = [&](PeerId id) {
+			return !owner.peerLoaded(id);
+		};
+		auto users = QVector<MTPUser>();
+		for (const auto &user : slice.users) {
+			if (unknown(PeerIdFromUser(user))) {
+				users.push_back(user);
+			}
+		}
+		auto chats = QVector<MTPChat>();
+		for (const auto &chat : slice.chats) {
+			if (unknown(PeerIdFromChat(chat))) {
+				chats.push_back(chat);
+			}
+		}
+		owner.processUsers(MTP_vector<MTPUser>(std::move(users)));
+		owner.processChats(MTP_vector<MTPChat>(std::move(chats)));
+
+		_localMessagesHistory = history;
+		_localMessageIds.clear();
+		for (const auto &message : slice.messages) {
+			const auto id = IdFromMessage(message);
+			if (!owner.message(history->peer, id)) {
+				_localMessageIds.push_back(id);
+			}
+		}
+		addMessagesToFront(history->peer, slice.messages);
+		historyLoaded();
+	}));
+}
+
+void HistoryWidget::clearLocalMessages(
+		const QVector<MTPMessage> *received) {
+	const auto local = base::take(_localMessagesHistory);
+	const auto ids = base::take(_localMessageIds);
+	if (!local) {
+		return;
+	}
+	auto &owner = local->owner();
+	auto confirmed = base::flat_set<MsgId>();
+	auto minConfirmed = MsgId();
+	auto maxConfirmed = MsgId();
+	if (received) {
+		for (const auto &message : *received) {
+			const auto id = IdFromMessage(message);
+			if (owner.message(local->peer, id)) {
+				owner.updateEditedMessage(message);
+			}
+			confirmed.emplace(id);
+			if (!minConfirmed || minConfirmed > id) {
+				minConfirmed = id;
+			}
+			if (maxConfirmed < id) {
+				maxConfirmed = id;
+			}
+		}
+	}
+
+	// Messages created from the local database and missing inside the
+	// range covered by the server slice were deleted meanwhile. Those
+	// outside of it are just unloaded together with the rest of history.
+	for (const auto id : ids) {
+		if (id > minConfirmed
+			&& id < maxConfirmed
+			&& !confirmed.contains(id)) {
+			if (const auto item = owner.message(local->peer, id)) {
+				item->destroy();
+			}
+		}
+	}
+	local->clear(History::ClearType::Unload);
 }
 
 void HistoryWidget::loadMessages() {
@@ -4113,7 +4235,7 @@ void HistoryWidget::loadMessages() {
 		}).fail([=](const MTP::Error &error) {
 			messagesFailed(error, _preloadRequest);
 			finish();
-		}).send();
+		}).parseInBackground().send();
 	});
 }
 
@@ -4179,7 +4301,7 @@ void HistoryWidget::loadMessagesDown() {
 		}).fail([=](const MTP::Error &error) {
 			messagesFailed(error, _preloadDownRequest);
 			finish();
-		}).send();
+		}).parseInBackground().send();
 	});
 }
 
@@ -4257,7 +4379,7 @@ void HistoryWidget::delayedShowAt(
 		}).fail([=](const MTP::Error &error) {
 			messagesFailed(error, _delayedShowAtRequest);
 			finish();
-		}).send();
+		}).parseInBackground().send();
 	});
 }
 
@@ -164,6 +164,8 @@ public:
 	void loadMessages();
 	void loadMessagesDown();
 	void firstLoadMessages();
+	void showLocalMessages(not_null<History*> history);
+	void clearLocalMessages(const QVector<MTPMessage> *received = nullptr);
 	void delayedShowAt(MsgId showAtMsgId, const Window::SectionShow &params);
 
 	bool updateReplaceMediaButton();
@@ -764,6 +766,8 @@ private:
 	bool _showAndMaybeSendStart = false;
 
 	int _firstLoadRequest = 0; // Not real mtpRequestId.
+	History *_localMessagesHistory = nullptr;
+	std::vector<MsgId> _localMessageIds;
 	int _preloadRequest = 0; // Not real mtpRequestId.
 	int _preloadDownRequest = 0; // Not real mtpRequestId.
 
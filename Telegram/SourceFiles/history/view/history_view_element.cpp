@@ -976,6 +976,14 @@ bool Element::pendingResize() const {
 	return _flags & Flag::NeedsResize;
 }
 
+void Element::setPendingLazyResize() {
+	_flags |= Flag::LazyResize;
+}
+
+bool Element::pendingLazyResize() const {
+	return _flags & Flag::LazyResize;
+}
+
 bool Element::isAttachedToPrevious() const {
 	return _flags & Flag::AttachedToPrevious;
 }
@@ -1681,6 +1689,7 @@ QSize Element::countOptimalSize() {
 }
 
 QSize Element::countCurrentSize(int newWidth) {
+	_flags &= ~Flag::LazyResize;
 	if (_flags & Flag::NeedsResize) {
 		initDimensions();
 	}
@@ -388,6 +388,7 @@ public:
 		TopicRootReply           = 0x0400,
 		MediaOverriden           = 0x0800,
 		HeavyCustomEmoji         = 0x1000,
+		LazyResize               = 0x2000,
 	};
 	using Flags = base::flags<Flag>;
 	friend inline constexpr auto is_flag_type(Flag) { return true; }
@@ -419,6 +420,10 @@ public:
 
 	void setPendingResize();
 	[[nodiscard]] bool pendingResize() const;
+
+	// Current height is kept as an estimate until the next layout.
+	void setPendingLazyResize();
+	[[nodiscard]] bool pendingLazyResize() const;
 	[[nodiscard]] bool isUnderCursor() const;
 
 	[[nodiscard]] bool isLastAndSelfMessage() const;
@@ -15,6 +15,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/view/history_view_cursor_state.h"
 #include "history/history_item_components.h"
 #include "history/history_item_helpers.h"
+#include "history/history_pool.h"
 #include "history/view/media/history_view_media_generic.h"
 #include "history/view/media/history_view_web_page.h"
 #include "history/view/media/history_view_suggest_decision.h"
@@ -57,6 +58,7 @@ namespace HistoryView {
 namespace {
 
 constexpr auto kPlayStatusLimit = 2;
+constexpr auto kMessagesInPoolChunk = 256;
 const auto kPsaTooltipPrefix = "cloud_lng_tooltip_psa_";
 
 class KeyboardStyle : public ReplyKeyboard::Style {
@@ -374,6 +376,14 @@ struct SecondRightAction final {
 	ClickHandlerPtr link;
 };
 
+[[nodiscard]] HistoryPool &MessagesPool() {
+	static const auto result = new HistoryPool(
+		"messages",
+		sizeof(Message),
+		kMessagesInPoolChunk);
+	return *result;
+}
+
 } // namespace
 
 struct Message::CommentsButton {
@@ -458,6 +468,16 @@ Message::~Message() {
 	}
 }
 
+void *Message::operator new(std::size_t size) {
+	Expects(size == sizeof(Message));
+
+	return MessagesPool().allocate();
+}
+
+void Message::operator delete(void *pointer) {
+	MessagesPool().deallocate(pointer);
+}
+
 void Message::refreshSuggestedInfo(
 		not_null<HistoryItem*> item,
 		not_null<const HistoryMessageSuggestedPost*> suggest,
@@ -71,6 +71,9 @@ public:
 		Element *replacing);
 	~Message();
 
+	static void *operator new(std::size_t size);
+	static void operator delete(void *pointer);
+
 	void clickHandlerPressedChanged(
 		const ClickHandlerPtr &handler,
 		bool pressed) override;
@@ -14,6 +14,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/history_item.h"
 #include "history/history_item_components.h"
 #include "history/history_item_helpers.h"
+#include "history/history_pool.h"
 #include "data/data_abstract_structure.h"
 #include "data/data_chat.h"
 #include "data/data_channel.h"
@@ -35,6 +36,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace HistoryView {
 namespace {
 
+constexpr auto kServicesInPoolChunk = 64;
+
 TextParseOptions EmptyLineOptions = {
 	TextParseMultiline, // flags
 	4096, // maxw
@@ -200,6 +203,14 @@ void SetText(Ui::Text::String &text, const QString &content) {
 	text.setText(st::serviceTextStyle, content, EmptyLineOptions);
 }
 
+[[nodiscard]] HistoryPool &ServicesPool() {
+	static const auto result = new HistoryPool(
+		"services",
+		sizeof(Service),
+		kServicesInPoolChunk);
+	return *result;
+}
+
 } // namespace
 
 int WideChatWidth() {
@@ -411,6 +422,16 @@ Service::Service(
 	setupReactions(replacing);
 }
 
+void *Service::operator new(std::size_t size) {
+	Expects(size == sizeof(Service));
+
+	return ServicesPool().allocate();
+}
+
+void Service::operator delete(void *pointer) {
+	ServicesPool().deallocate(pointer);
+}
+
 QRect Service::innerGeometry() const {
 	return countGeometry();
 }
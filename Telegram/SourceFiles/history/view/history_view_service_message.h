@@ -33,6 +33,9 @@ public:
 		not_null<HistoryItem*> data,
 		Element *replacing);
 
+	static void *operator new(std::size_t size);
+	static void operator delete(void *pointer);
+
 	int marginTop() const override;
 	int marginBottom() const override;
 	bool isHidden() const override;
@@ -36,6 +36,10 @@ namespace {
 constexpr auto kClipThreadsCount = 8;
 constexpr auto kAverageGifSize = 320 * 240;
 constexpr auto kWaitBeforeGifPause = crl::time(200);
+constexpr auto kBusyWindow = crl::time(1000);
+
+// Threads with busy values closer than that are considered equally busy.
+constexpr auto kBusyMargin = 50;
 
 QImage PrepareFrame(
 		const FrameRequest &request,
@@ -127,6 +131,11 @@ public:
 	int loadLevel() const {
 		return _loadLevel;
 	}
+
+	// Per mille of the time spent decoding frames in the last window.
+	int busy() const {
+		return _busy.loadAcquire();
+	}
 	void append(Reader *reader, const Core::FileLocation &location, const QByteArray &data);
 	void start(Reader *reader);
 	void update(Reader *reader);
@@ -138,8 +147,16 @@ private:
 	void finish();
 	void callback(Reader *reader, Notification notification);
 	void clear();
+	void accountDecode(
+		ReaderPrivate *reader,
+		crl::profile_time time,
+		crl::time deadline);
+	void updateBusy(crl::time now);
 
 	QAtomicInt _loadLevel;
+	QAtomicInt _busy;
+	crl::profile_time _busyTime = 0;
+	crl::time _busyWindowStart = 0;
 	using ReaderPointers = QMap<Reader*, QAtomicInt>;
 	ReaderPointers _readerPointers;
 	mutable QMutex _readerPointersMutex;
@@ -207,10 +224,20 @@ void Reader::init(const Core::FileLocation &location, const QByteArray &data) {
 		_threadIndex = Workers.size();
 		Workers.push_back(std::make_unique<Worker>());
 	} else {
+		// Prefer the threads that spend the least time decoding and
+		// spread the new readers by their sizes between equally busy.
+		auto minBusy = std::numeric_limits<int>::max();
+		for (const auto &worker : Workers) {
+			minBusy = std::min(minBusy, worker->manager.busy());
+		}
 		_threadIndex = base::RandomIndex(Workers.size());
-		auto loadLevel = 0x7FFFFFFF;
+		auto loadLevel = std::numeric_limits<int>::max();
 		for (int i = 0, l = int(Workers.size()); i < l; ++i) {
-			const auto level = Workers[i]->manager.loadLevel();
+			const auto &manager = Workers[i]->manager;
+			if (manager.busy() > minBusy + kBusyMargin) {
+				continue;
+			}
+			const auto level = manager.loadLevel();
 			if (level < loadLevel) {
 				_threadIndex = i;
 				loadLevel = level;
@@ -439,6 +466,14 @@ State Reader::state() const {
 	return _state;
 }
 
+Reader::DecodeStats Reader::decodeStats() const {
+	return {
+		.averageDecodeTime = _averageDecodeTime.loadAcquire(),
+		.framesDecoded = _framesDecoded.loadAcquire(),
+		.framesLate = _framesLate.loadAcquire(),
+	};
+}
+
 void Reader::stop() {
 	if (Workers.size() <= _threadIndex) {
 		error();
@@ -687,6 +722,10 @@ private:
 	bool _started = false;
 	crl::time _videoPausedAtMs = 0;
 
+	crl::profile_time _averageDecodeTime = 0;
+	int _framesDecoded = 0;
+	int _framesLate = 0;
+
 	friend class Manager;
 
 };
@@ -809,6 +848,10 @@ bool Manager::handleProcessResult(ReaderPrivate *reader, ProcessResult result, c
 		frame->index = reader->frame()->index;
 		frame->displayed.storeRelease(0);
 		frame->positionMs = reader->frame()->positionMs;
+		it.key()->_averageDecodeTime.storeRelease(
+			int(reader->_averageDecodeTime));
+		it.key()->_framesDecoded.storeRelease(reader->_framesDecoded);
+		it.key()->_framesLate.storeRelease(reader->_framesLate);
 		if (result == ProcessResult::Started) {
 			reader->startedAt(ms);
 			it.key()->moveToNextWrite();
@@ -851,7 +894,11 @@ Manager::ResultHandleState Manager::handleResult(ReaderPrivate *reader, ProcessR
 				reader->_frame = index;
 			}
 		}
-		return handleResult(reader, reader->finishProcess(ms), ms);
+		const auto deadline = reader->_nextFrameWhen;
+		const auto started = crl::profile();
+		const auto finished = reader->finishProcess(ms);
+		accountDecode(reader, crl::profile() - started, deadline);
+		return handleResult(reader, finished, ms);
 	}
 
 	return ResultHandleContinue;
@@ -894,26 +941,36 @@ void Manager::process() {
 		checkAllReaders = (_readers.size() > _readerPointers.size());
 	}
 
+	// Handle the readers with the earliest frame deadlines first.
+	auto due = std::vector<std::pair<crl::time, ReaderPrivate*>>();
+	for (auto i = _readers.cbegin(), e = _readers.cend(); i != e; ++i) {
+		if (i.value() <= ms) {
+			due.emplace_back(i.value(), i.key());
+		}
+	}
+	ranges::sort(due);
+	for (const auto &[when, reader] : due) {
+		ResultHandleState state = handleResult(reader, reader->process(ms), ms);
+		if (state == ResultHandleRemove) {
+			_readers.remove(reader);
+			continue;
+		} else if (state == ResultHandleStop) {
+			_processingInThread = nullptr;
+			return;
+		}
+		ms = crl::now();
+		if (reader->_videoPausedAtMs) {
+			_readers[reader] = ms + 86400 * 1000ULL;
+		} else if (reader->_nextFrameWhen && reader->_started) {
+			_readers[reader] = reader->_nextFrameWhen;
+		} else {
+			_readers[reader] = (ms + 86400 * 1000ULL);
+		}
+	}
+
 	for (auto i = _readers.begin(), e = _readers.end(); i != e;) {
 		ReaderPrivate *reader = i.key();
-		if (i.value() <= ms) {
-			ResultHandleState state = handleResult(reader, reader->process(ms), ms);
-			if (state == ResultHandleRemove) {
-				i = _readers.erase(i);
-				continue;
-			} else if (state == ResultHandleStop) {
-				_processingInThread = nullptr;
-				return;
-			}
-			ms = crl::now();
-			if (reader->_videoPausedAtMs) {
-				i.value() = ms + 86400 * 1000ULL;
-			} else if (reader->_nextFrameWhen && reader->_started) {
-				i.value() = reader->_nextFrameWhen;
-			} else {
-				i.value() = (ms + 86400 * 1000ULL);
-			}
-		} else if (checkAllReaders) {
+		if (checkAllReaders) {
 			QMutexLocker lock(&_readerPointersMutex);
 			auto it = constUnsafeFindReaderPointer(reader);
 			if (it == _readerPointers.cend()) {
@@ -930,6 +987,7 @@ void Manager::process() {
 	}
 
 	ms = crl::now();
+	updateBusy(ms);
 	if (_needReProcess || minms <= ms) {
 		_needReProcess = false;
 		_timer.start(1);
@@ -940,6 +998,38 @@ void Manager::process() {
 	_processingInThread = nullptr;
 }
 
+void Manager::accountDecode(
+		ReaderPrivate *reader,
+		crl::profile_time time,
+		crl::time deadline) {
+	_busyTime += time;
+
+	auto &average = reader->_averageDecodeTime;
+	average = reader->_framesDecoded
+		? ((average * 7 + time) / 8)
+		: time;
+	++reader->_framesDecoded;
+	if (deadline && crl::now() > deadline) {
+		++reader->_framesLate;
+	}
+}
+
+void Manager::updateBusy(crl::time now) {
+	if (_readers.isEmpty()) {
+		_busyTime = 0;
+		_busyWindowStart = now;
+		_busy.storeRelease(0);
+		return;
+	}
+	const auto elapsed = now - _busyWindowStart;
+	if (elapsed < kBusyWindow) {
+		return;
+	}
+	_busy.storeRelease(int(std::min(_busyTime / elapsed, crl::profile_time(1000))));
+	_busyTime = 0;
+	_busyWindowStart = now;
+}
+
 void Manager::finish() {
 	_timer.stop();
 	clear();
@@ -113,6 +113,13 @@ public:
 		return _threadIndex;
 	}
 
+	struct DecodeStats {
+		int averageDecodeTime = 0; // In microseconds.
+		int framesDecoded = 0;
+		int framesLate = 0;
+	};
+	[[nodiscard]] DecodeStats decodeStats() const;
+
 	[[nodiscard]] int width() const;
 	[[nodiscard]] int height() const;
 
@@ -175,6 +182,10 @@ private:
 	QAtomicInt _videoPauseRequest = 0;
 	int32 _threadIndex;
 
+	QAtomicInt _averageDecodeTime = 0;
+	QAtomicInt _framesDecoded = 0;
+	QAtomicInt _framesLate = 0;
+
 	friend class Manager;
 
 	ReaderPrivate *_private = nullptr;
@@ -685,7 +685,7 @@ void TlsSocket::readHello() {
 		if (!_socket.bytesAvailable()) {
 			return;
 		}
-		_incoming.append(_socket.readAll());
+		readIncoming();
 	}
 	checkHelloParts12(parts1Size);
 }
@@ -773,7 +773,7 @@ void TlsSocket::readData() {
 	if (!isConnected()) {
 		return;
 	}
-	_incoming.append(_socket.readAll());
+	readIncoming();
 	if (!checkNextPacket()) {
 		handleError();
 	} else if (hasBytesAvailable()) {
@@ -781,6 +781,18 @@ void TlsSocket::readData() {
 	}
 }
 
+void TlsSocket::readIncoming() {
+	// Read straight to the end of _incoming instead of readAll() + append.
+	const auto available = int(_socket.bytesAvailable());
+	if (available <= 0) {
+		return;
+	}
+	const auto size = int(_incoming.size());
+	_incoming.resize(size + available);
+	const auto read = _socket.read(_incoming.data() + size, available);
+	_incoming.resize(size + int(std::max(read, qint64(0))));
+}
+
 bool TlsSocket::checkNextPacket() {
 	auto offset = 0;
 	const auto incoming = bytes::make_span(_incoming);
@@ -52,6 +52,7 @@ private:
 	void checkHelloParts34(int parts123Size);
 	void checkHelloDigest();
 	void readData();
+	void readIncoming();
 	[[nodiscard]] bool checkNextPacket();
 	void shiftIncomingBy(int amount);
 
@@ -32,6 +32,7 @@ namespace {
 
 constexpr auto kConfigBecomesOldIn = 2 * 60 * crl::time(1000);
 constexpr auto kConfigBecomesOldForBlockedIn = 8 * crl::time(1000);
+constexpr auto kSlowResponseDuration = crl::time(8);
 
 using namespace details;
 
@@ -137,6 +138,7 @@ public:
 		ResponseHandler &&callbacks);
 	SerializedRequest getRequest(mtpRequestId requestId);
 	[[nodiscard]] bool hasCallback(mtpRequestId requestId) const;
+	void parseResponse(Response &response) const;
 	void processCallback(const Response &response);
 	void processUpdate(const Response &message);
 
@@ -182,6 +184,13 @@ public:
 	[[nodiscard]] rpl::lifetime &lifetime();
 
 private:
+	struct ResponseTiming {
+		crl::time total = 0;
+		int count = 0;
+	};
+
+	bool processDone(ResponseHandler &handler, const Response &response);
+
 	void importDone(
 		const MTPauth_Authorization &result,
 		const Response &response);
@@ -268,6 +277,9 @@ private:
 	std::map<mtpRequestId, ResponseHandler> _parserMap;
 	mutable QMutex _parserMapLock;
 
+	// Main thread time spent in done handlers by response constructor.
+	base::flat_map<mtpTypeId, ResponseTiming> _responseTimings;
+
 	std::map<mtpRequestId, SerializedRequest> _requestMap;
 	QReadWriteLock _requestMapLock;
 
@@ -1142,6 +1154,54 @@ bool Instance::Private::hasCallback(mtpRequestId requestId) const {
 	return (it != _parserMap.cend());
 }
 
+void Instance::Private::parseResponse(Response &response) const {
+	auto parse = ParseHandler();
+	{
+		QMutexLocker locker(&_parserMapLock);
+		const auto i = _parserMap.find(response.requestId);
+		if (i == _parserMap.cend() || !i->second.parse) {
+			return;
+		}
+		parse = i->second.parse;
+	}
+
+	// If reading fails here, the done handler reads it once again
+	// on the main thread and reports the error in the usual way.
+	response.parsed = parse(response.reply);
+}
+
+bool Instance::Private::processDone(
+		ResponseHandler &handler,
+		const Response &response) {
+	if (!Logs::DebugEnabled()) {
+		return handler.done(response);
+	}
+	const auto type = response.reply.isEmpty()
+		? mtpTypeId(0)
+		: mtpTypeId(response.reply[0]);
+	const auto guard = QPointer<Instance>(_instance);
+	const auto started = crl::now();
+	const auto result = handler.done(response);
+	const auto duration = crl::now() - started;
+	if (!guard) {
+		return result;
+	}
+	auto &timing = _responseTimings[type];
+	timing.total += duration;
+	++timing.count;
+	if (duration >= kSlowResponseDuration) {
+		DEBUG_LOG(("RPC Info: response 0x%1 to request %2 took %3 ms "
+			"on the main thread (%4, total %5 ms in %6 responses)."
+			).arg(type, 8, 16, QChar('0')
+			).arg(response.requestId
+			).arg(duration
+			).arg(response.parsed ? u"parsed"_q : u"not parsed"_q
+			).arg(timing.total
+			).arg(timing.count));
+	}
+	return result;
+}
+
 void Instance::Private::processCallback(const Response &response) {
 	const auto requestId = response.requestId;
 	ResponseHandler handler;
@@ -1186,7 +1246,7 @@ void Instance::Private::processCallback(const Response &response) {
 						"Error parse failed.")));
 		} else {
 			const auto guard = QPointer<Instance>(_instance);
-			if (handler.done && !handler.done(response) && guard) {
+			if (handler.done && !processDone(handler, response) && guard) {
 				handleError(Error::Local(
 					"RESPONSE_PARSE_FAILED",
 					"Response parse failed."));
@@ -2069,6 +2129,10 @@ bool Instance::hasCallback(mtpRequestId requestId) const {
 	return _private->hasCallback(requestId);
 }
 
+void Instance::parseResponse(Response &response) const {
+	_private->parseResponse(response);
+}
+
 void Instance::processCallback(const Response &response) {
 	_private->processCallback(response);
 }
@@ -118,6 +118,9 @@ public:
 	void processCallback(const Response &response);
 	void processUpdate(const Response &message);
 
+	// Session thread, reads the result if the request asked for it.
+	void parseResponse(Response &response) const;
+
 	// return true if need to clean request data
 	bool rpcErrorOccured(
 		const Response &response,
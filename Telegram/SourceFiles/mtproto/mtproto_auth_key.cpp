@@ -11,7 +11,104 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include <QtCore/QDataStream>
 
+#include <openssl/evp.h>
+
 namespace MTP {
+namespace {
+
+constexpr auto kIgeBlockSize = 16;
+constexpr auto kMaxCipherPart = 0x10000000;
+
+struct IgeContexts {
+	IgeContexts()
+	: encrypt(EVP_CIPHER_CTX_new())
+	, decrypt(EVP_CIPHER_CTX_new()) {
+	}
+
+	std::unique_ptr<
+		EVP_CIPHER_CTX,
+		details::CipherContextDeleter> encrypt;
+	std::unique_ptr<
+		EVP_CIPHER_CTX,
+		details::CipherContextDeleter> decrypt;
+};
+
+// Each message has its own key, but the contexts are reused.
+[[nodiscard]] EVP_CIPHER_CTX *IgeContext(bool encrypt) {
+	thread_local const auto result = IgeContexts();
+	return encrypt ? result.encrypt.get() : result.decrypt.get();
+}
+
+inline void XorBlock(uchar *to, const uchar *what) {
+	for (auto i = 0; i != kIgeBlockSize; ++i) {
+		to[i] ^= what[i];
+	}
+}
+
+// IGE is not available through EVP, so it is built from single ECB block
+// operations, which still use the hardware accelerated implementation:
+// c[i] = E(m[i] ^ c[i - 1]) ^ m[i - 1] and the other way for decryption.
+void AesIge(
+		const void *src,
+		void *dst,
+		uint32 len,
+		const void *key,
+		const void *iv,
+		bool encrypt) {
+	Expects(!(len % kIgeBlockSize));
+
+	const auto context = IgeContext(encrypt);
+	Assert(context != nullptr);
+
+	const auto ivBytes = static_cast<const uchar*>(iv);
+	const auto initialized = EVP_CipherInit_ex(
+		context,
+		EVP_aes_256_ecb(),
+		nullptr,
+		static_cast<const uchar*>(key),
+		nullptr,
+		encrypt ? 1 : 0);
+	Assert(initialized == 1);
+	EVP_CIPHER_CTX_set_padding(context, 0);
+
+	// For encryption the first half of iv is the previous output block and
+	// the second half is the previous input block, for decryption vice versa.
+	uchar previousInput[kIgeBlockSize];
+	uchar previousOutput[kIgeBlockSize];
+	memcpy(
+		encrypt ? previousOutput : previousInput,
+		ivBytes,
+		kIgeBlockSize);
+	memcpy(
+		encrypt ? previousInput : previousOutput,
+		ivBytes + kIgeBlockSize,
+		kIgeBlockSize);
+
+	auto input = static_cast<const uchar*>(src);
+	auto output = static_cast<uchar*>(dst);
+	uchar block[kIgeBlockSize];
+	uchar inputCopy[kIgeBlockSize];
+	for (auto i = uint32(); i != len; i += kIgeBlockSize) {
+		memcpy(inputCopy, input + i, kIgeBlockSize);
+		memcpy(block, inputCopy, kIgeBlockSize);
+		XorBlock(block, previousOutput);
+
+		auto written = 0;
+		EVP_CipherUpdate(
+			context,
+			output + i,
+			&written,
+			block,
+			kIgeBlockSize);
+		Assert(written == kIgeBlockSize);
+		XorBlock(output + i, previousInput);
+
+		memcpy(previousOutput, output + i, kIgeBlockSize);
+		memcpy(previousInput, inputCopy, kIgeBlockSize);
+	}
+}
+
+} // namespace
 
 AuthKey::AuthKey(Type type, DcId dcId, const Data &data)
 : _type(type)
@@ -149,41 +246,69 @@ void AuthKey::countKeyId() {
 }
 
 void aesIgeEncryptRaw(const void *src, void *dst, uint32 len, const void *key, const void *iv) {
-	uchar aes_key[32], aes_iv[32];
-	memcpy(aes_key, key, 32);
-	memcpy(aes_iv, iv, 32);
-
-	AES_KEY aes;
-	AES_set_encrypt_key(aes_key, 256, &aes);
-	AES_ige_encrypt(static_cast<const uchar*>(src), static_cast<uchar*>(dst), len, &aes, aes_iv, AES_ENCRYPT);
+	AesIge(src, dst, len, key, iv, true);
 }
 
 void aesIgeDecryptRaw(const void *src, void *dst, uint32 len, const void *key, const void *iv) {
-	uchar aes_key[32], aes_iv[32];
-	memcpy(aes_key, key, 32);
-	memcpy(aes_iv, iv, 32);
-
-	AES_KEY aes;
-	AES_set_decrypt_key(aes_key, 256, &aes);
-	AES_ige_encrypt(static_cast<const uchar*>(src), static_cast<uchar*>(dst), len, &aes, aes_iv, AES_DECRYPT);
-}
-
-void aesCtrEncrypt(bytes::span data, const void *key, CTRState *state) {
-	AES_KEY aes;
-	AES_set_encrypt_key(static_cast<const uchar*>(key), 256, &aes);
-
-	static_assert(CTRState::IvecSize == AES_BLOCK_SIZE, "Wrong size of ctr ivec!");
-	static_assert(CTRState::EcountSize == AES_BLOCK_SIZE, "Wrong size of ctr ecount!");
-
-	CRYPTO_ctr128_encrypt(
-		reinterpret_cast<const uchar*>(data.data()),
-		reinterpret_cast<uchar*>(data.data()),
-		data.size(),
-		&aes,
-		state->ivec,
-		state->ecount,
-		&state->num,
-		(block128_f)AES_encrypt);
+	AesIge(src, dst, len, key, iv, false);
+}
+
+namespace details {
+
+void CipherContextDeleter::operator()(evp_cipher_ctx_st *context) const {
+	EVP_CIPHER_CTX_free(context);
+}
+
+} // namespace details
+
+CTRCipher::CTRCipher(bytes::const_span key, bytes::const_span iv)
+: _context(EVP_CIPHER_CTX_new()) {
+	Expects(key.size() == CTRState::KeySize);
+	Expects(iv.size() == CTRState::IvecSize);
+
+	if (!_context) {
+		LOG(("MTP Error: Could not create CTR cipher context."));
+		return;
+	}
+	const auto result = EVP_EncryptInit_ex(
+		_context.get(),
+		EVP_aes_256_ctr(),
+		nullptr,
+		reinterpret_cast<const uchar*>(key.data()),
+		reinterpret_cast<const uchar*>(iv.data()));
+	if (result != 1) {
+		LOG(("MTP Error: Could not init CTR cipher, result %1."
+			).arg(result));
+		_context = nullptr;
+	}
+}
+
+bool CTRCipher::valid() const {
+	return (_context != nullptr);
+}
+
+void CTRCipher::encrypt(bytes::span data) {
+	encrypt(data, data);
+}
+
+void CTRCipher::encrypt(bytes::const_span from, bytes::span to) {
+	Expects(valid());
+	Expects(to.size() >= from.size());
+
+	// CTR mode keeps the position inside the key stream between calls.
+	auto left = from.size();
+	auto input = reinterpret_cast<const uchar*>(from.data());
+	auto output = reinterpret_cast<uchar*>(to.data());
+	while (left > 0) {
+		const auto part = int(std::min(left, std::size_t(kMaxCipherPart)));
+		auto written = 0;
+		EVP_EncryptUpdate(_context.get(), output, &written, input, part);
+		Assert(written == part);
+
+		input += part;
+		output += part;
+		left -= part;
+	}
 }
 
 } // namespace MTP
@@ -11,6 +11,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include <array>
 #include <memory>
 
+struct evp_cipher_ctx_st;
+
 namespace MTP {
 
 class AuthKey {
@@ -110,16 +112,38 @@ inline void aesDecryptLocal(const void *src, void *dst, uint32 len, const AuthKe
 	return aesIgeDecryptRaw(src, dst, len, static_cast<const void*>(&aesKey), static_cast<const void*>(&aesIV));
 }
 
-// ctr used inplace, encrypt the data and leave it at the same place
 struct CTRState {
 	static constexpr int KeySize = 32;
 	static constexpr int IvecSize = 16;
-	static constexpr int EcountSize = 16;
+};
+
+namespace details {
+
+struct CipherContextDeleter {
+	void operator()(evp_cipher_ctx_st *context) const;
+};
+
+} // namespace details
+
+// AES-256-CTR stream with the key schedule expanded once, for the whole
+// lifetime of the stream. Goes through EVP, so that OpenSSL may use the
+// hardware accelerated (AES-NI / ARMv8 crypto) implementation.
+class CTRCipher final {
+public:
+	CTRCipher() = default;
+	CTRCipher(bytes::const_span key, bytes::const_span iv);
+
+	[[nodiscard]] bool valid() const;
+
+	// In place or into a caller-provided buffer of the same size.
+	void encrypt(bytes::span data);
+	void encrypt(bytes::const_span from, bytes::span to);
+
+private:
+	std::unique_ptr<
+		evp_cipher_ctx_st,
+		details::CipherContextDeleter> _context;
 
-	uchar ivec[IvecSize] = { 0 };
-	uint32 num = 0;
-	uchar ecount[EcountSize] = { 0 };
 };
-void aesCtrEncrypt(bytes::span data, const void *key, CTRState *state);
 
 } // namespace MTP
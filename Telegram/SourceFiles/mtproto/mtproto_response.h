@@ -59,14 +59,21 @@ struct Response {
 	mtpBuffer reply;
 	mtpMsgId outerMsgId = 0;
 	mtpRequestId requestId = 0;
+
+	// Result already read on the session thread, if it was requested.
+	std::shared_ptr<const void> parsed;
 };
 
 using DoneHandler = FnMut<bool(const Response&)>;
 using FailHandler = Fn<bool(const Error&, const Response&)>;
 
+// Called on the session thread, should only read the reply.
+using ParseHandler = Fn<std::shared_ptr<const void>(const mtpBuffer&)>;
+
 struct ResponseHandler {
 	DoneHandler done;
 	FailHandler fail;
+	ParseHandler parse;
 };
 
 } // namespace MTP
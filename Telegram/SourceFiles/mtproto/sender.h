@@ -45,9 +45,13 @@ class Sender {
 				auto onstack = std::move(handler);
 				sender->senderRequestHandled(response.requestId);
 
-				auto result = Result();
+				auto read = Result();
+				const auto parsed = static_cast<const Result*>(
+					response.parsed.get());
 				auto from = response.reply.constData();
-				if (!result.read(from, from + response.reply.size())) {
+				const auto till = from + response.reply.size();
+				const auto &result = parsed ? *parsed : read;
+				if (!parsed && !read.read(from, till)) {
 					return false;
 				} else if (!onstack) {
 					return true;
@@ -149,6 +153,9 @@ class Sender {
 		void setAfter(mtpRequestId requestId) noexcept {
 			_afterRequestId = requestId;
 		}
+		void setParseInBackground() noexcept {
+			_parseInBackground = true;
+		}
 
 		[[nodiscard]] ShiftedDcId takeDcId() const noexcept {
 			return _dcId;
@@ -167,6 +174,19 @@ class Sender {
 					_failSkipPolicy);
 			});
 		}
+		template <typename Result>
+		[[nodiscard]] ParseHandler takeOnParse() const {
+			if (!_parseInBackground) {
+				return nullptr;
+			}
+			return [](const mtpBuffer &reply) {
+				auto result = std::make_shared<Result>();
+				auto from = reply.constData();
+				return result->read(from, from + reply.size())
+					? std::shared_ptr<const void>(std::move(result))
+					: nullptr;
+			};
+		}
 		[[nodiscard]] mtpRequestId takeAfter() const noexcept {
 			return _afterRequestId;
 		}
@@ -194,6 +214,7 @@ class Sender {
 		FailSkipPolicy _failSkipPolicy = FailSkipPolicy::Simple;
 		mtpRequestId _afterRequestId = 0;
 		mtpRequestId _overrideRequestId = 0;
+		bool _parseInBackground = false;
 
 	};
 
@@ -300,11 +321,21 @@ public:
 			return *this;
 		}
 
+		// Read the result on the session thread, so that only the handler
+		// itself runs on the main thread. Useful for large responses.
+		[[nodiscard]] SpecificRequestBuilder &parseInBackground() noexcept {
+			setParseInBackground();
+			return *this;
+		}
+
 		mtpRequestId send() {
 			const auto id = sender()->_instance->send(
 				_request,
-				takeOnDone(),
-				takeOnFail(),
+				ResponseHandler{
+					.done = takeOnDone(),
+					.fail = takeOnFail(),
+					.parse = takeOnParse<Result>(),
+				},
 				takeDcId(),
 				takeCanWait(),
 				takeAfter(),
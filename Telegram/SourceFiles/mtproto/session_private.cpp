@@ -1281,7 +1281,7 @@ void SessionPrivate::handleReceived() {
 		constexpr auto kMinimalEncryptedIntsCount = kEncryptedHeaderIntsCount + 4U; // + 1 data + 3 padding
 		constexpr auto kMinimalIntsCount = kExternalHeaderIntsCount + kMinimalEncryptedIntsCount;
 		auto intsCount = uint32(intsBuffer.size());
-		auto ints = intsBuffer.constData();
+		auto ints = intsBuffer.data();
 		if ((intsCount < kMinimalIntsCount) || (intsCount > kMaxMessageLength / kIntSize)) {
 			LOG(("TCP Error: bad message received, len %1").arg(intsCount * kIntSize));
 			return restart();
@@ -1297,12 +1297,12 @@ void SessionPrivate::handleReceived() {
 		auto encryptedInts = ints + kExternalHeaderIntsCount;
 		auto encryptedIntsCount = (intsCount - kExternalHeaderIntsCount) & ~0x03U;
 		auto encryptedBytesCount = encryptedIntsCount * kIntSize;
-		auto decryptedBuffer = QByteArray(encryptedBytesCount, Qt::Uninitialized);
 		auto msgKey = *(MTPint128*)(ints + 2);
 
-		aesIgeDecrypt(encryptedInts, decryptedBuffer.data(), encryptedBytesCount, _encryptionKey, msgKey);
+		// Decrypt in place, the received packet is not needed anymore.
+		aesIgeDecrypt(encryptedInts, encryptedInts, encryptedBytesCount, _encryptionKey, msgKey);
 
-		auto decryptedInts = reinterpret_cast<const mtpPrime*>(decryptedBuffer.constData());
+		const auto decryptedInts = static_cast<const mtpPrime*>(encryptedInts);
 		auto serverSalt = *(uint64*)&decryptedInts[0];
 		auto session = *(uint64*)&decryptedInts[2];
 		auto msgId = *(uint64*)&decryptedInts[4];
@@ -1402,6 +1402,7 @@ void SessionPrivate::handleReceived() {
 				.serverSalt = serverSalt,
 				.serverTime = serverTime,
 				.badTime = badTime,
+				.buffer = &intsBuffer,
 			});
 		} else if (registered == ReceivedIdsManager::Result::TooOld) {
 			res = HandleResult::ResetSession;
@@ -1461,6 +1462,7 @@ SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
 		if (response.empty()) {
 			return HandleResult::RestartConnection;
 		}
+		info.buffer = &response;
 		return handleOneReceived(response.data(), response.data() + response.size(), msgId, info);
 	}
 
@@ -1471,6 +1473,7 @@ SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
 
 		const mtpPrime *otherEnd;
 		const auto msgsCount = (uint32)*(from++);
+		info.buffer = nullptr;
 		DEBUG_LOG(("Message Info: container received, count: %1").arg(msgsCount));
 		for (uint32 i = 0; i < msgsCount; ++i) {
 			if (from + 4 >= end) {
@@ -1848,6 +1851,17 @@ SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
 				return HandleResult::RestartConnection;
 			}
 			typeId = response[0];
+		} else if (info.buffer) {
+			// The message is this single result, move it to the start
+			// of the buffer, so that a large file part is not copied
+			// to a freshly allocated buffer.
+			const auto size = int(end - from);
+			const auto data = info.buffer->data();
+			Assert(from >= data && end <= data + info.buffer->size());
+			memmove(data, from, size * sizeof(mtpPrime));
+			info.buffer->resize(size);
+			response = base::take(*info.buffer);
+			info.buffer = nullptr;
 		} else {
 			response.resize(end - from);
 			memcpy(response.data(), from, (end - from) * sizeof(mtpPrime));
@@ -1870,13 +1884,19 @@ SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
 		}
 		const auto requestId = wasSent(requestMsgId);
 		if (requestId && requestId != mtpRequestId(0xFFFFFFFF)) {
-			// Save rpc_result for processing in the main thread.
-			QWriteLocker locker(_sessionData->haveReceivedMutex());
-			_sessionData->haveReceivedMessages().push_back({
+			auto received = Response{
 				.reply = std::move(response),
 				.outerMsgId = info.outerMsgId,
 				.requestId = requestId,
-			});
+			};
+			if (typeId != mtpc_rpc_error) {
+				_instance->parseResponse(received);
+			}
+
+			// Save rpc_result for processing in the main thread.
+			QWriteLocker locker(_sessionData->haveReceivedMutex());
+			_sessionData->haveReceivedMessages().push_back(
+				std::move(received));
 		} else {
 			DEBUG_LOG(("RPC Info: requestId not found for msgId %1").arg(requestMsgId));
 		}
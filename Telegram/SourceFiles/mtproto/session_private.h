@@ -124,6 +124,9 @@ private:
 		uint64 serverSalt = 0;
 		int32 serverTime = 0;
 		bool badTime = false;
+
+		// Buffer holding the message, rpc_result may reuse its memory.
+		mtpBuffer *buffer = nullptr;
 	};
 	[[nodiscard]] HandleResult handleOneReceived(
 		const mtpPrime *from,
@@ -64,6 +64,7 @@ TextParseOptions _documentNameOptions = {
 
 constexpr auto kMaxInlineArea = 1280 * 720;
 constexpr auto kStoryRatio = 1.46;
+constexpr auto kPreparedFramesBudget = int64(48 * 1024 * 1024);
 
 [[nodiscard]] bool CanPlayInline(not_null<DocumentData*> document) {
 	const auto dimensions = document->dimensions;
@@ -100,6 +101,123 @@ constexpr auto kStoryRatio = 1.46;
 	}
 }
 
+[[nodiscard]] QImage ScaleMediaFramePlaceholder(
+		const QImage &previous,
+		int width,
+		int height) {
+	const auto ratio = style::DevicePixelRatio();
+	auto result = previous.scaled(
+		width * ratio,
+		height * ratio,
+		Qt::IgnoreAspectRatio,
+		Qt::FastTransformation);
+	result.setDevicePixelRatio(ratio);
+	return result;
+}
+
+[[nodiscard]] base::binary_guard PrepareMediaFrameAsync(
+		QImage original,
+		int width,
+		int height,
+		bool blur,
+		Fn<void(QImage)> done) {
+	auto result = base::binary_guard();
+	crl::async([
+		=,
+		original = std::move(original),
+		guard = result.make_guard()
+	]() mutable {
+		if (!guard.alive()) {
+			return;
+		}
+		if (blur) {
+			original = Images::Blur(std::move(original));
+		}
+		crl::on_main(std::move(guard), [
+			=,
+			frame = CropMediaFrame(std::move(original), width, height)
+		]() mutable {
+			done(std::move(frame));
+		});
+	});
+	return result;
+}
+
+// Prepared frames of loaded photos and video thumbnails, so that scrolling
+// back and forth through a long media list doesn't scale the same large
+// images again. Main thread only, LRU evicted.
+class PreparedFrames final {
+public:
+	[[nodiscard]] static PreparedFrames &Instance();
+
+	[[nodiscard]] QImage find(uint64 id, bool document, QSize size);
+	void insert(uint64 id, bool document, QImage frame);
+
+private:
+	struct Key {
+		uint64 id = 0;
+		bool document = false;
+		int width = 0;
+		int height = 0;
+
+		friend inline auto operator<=>(Key, Key) = default;
+	};
+	struct Entry {
+		QImage frame;
+		std::list<Key>::iterator lru;
+	};
+
+	[[nodiscard]] static int64 ComputeBytes(const QImage &frame);
+
+	std::map<Key, Entry> _entries;
+	std::list<Key> _lru;
+	int64 _bytes = 0;
+
+};
+
+PreparedFrames &PreparedFrames::Instance() {
+	static auto result = PreparedFrames();
+	return result;
+}
+
+int64 PreparedFrames::ComputeBytes(const QImage &frame) {
+	return int64(frame.bytesPerLine()) * frame.height();
+}
+
+QImage PreparedFrames::find(uint64 id, bool document, QSize size) {
+	const auto key = Key{ id, document, size.width(), size.height() };
+	const auto i = _entries.find(key);
+	if (i == end(_entries)) {
+		return QImage();
+	}
+	_lru.splice(end(_lru), _lru, i->second.lru);
+	return i->second.frame;
+}
+
+void PreparedFrames::insert(uint64 id, bool document, QImage frame) {
+	const auto size = frame.size();
+	const auto key = Key{ id, document, size.width(), size.height() };
+	const auto bytes = ComputeBytes(frame);
+	const auto i = _entries.find(key);
+	if (i != end(_entries)) {
+		_bytes += bytes - ComputeBytes(i->second.frame);
+		i->second.frame = std::move(frame);
+		_lru.splice(end(_lru), _lru, i->second.lru);
+	} else {
+		_bytes += bytes;
+		_entries.emplace(key, Entry{
+			.frame = std::move(frame),
+			.lru = _lru.insert(end(_lru), key),
+		});
+	}
+	while (_bytes > kPreparedFramesBudget && _lru.size() > 1) {
+		const auto j = _entries.find(_lru.front());
+		_bytes -= ComputeBytes(j->second.frame);
+		_entries.erase(j);
+		_lru.pop_front();
+	}
+}
+
 void PaintSensitiveTag(Painter &p, QRect r) {
 	auto text = Ui::Text::String();
 	text.setText(
@@ -347,29 +465,7 @@ int32 Photo::resizeGetHeight(int32 width) {
 
 void Photo::paint(Painter &p, const QRect &clip, TextSelection selection, const PaintContext *context) {
 	const auto selected = (selection == FullSelection);
-	const auto widthChanged = (_pix.width()
-		!= (_width * style::DevicePixelRatio()));
-	if (!_goodLoaded || widthChanged) {
-		ensureDataMediaCreated();
-		const auto good = !_spoiler
-			&& (_dataMedia->loaded()
-				|| _dataMedia->image(Data::PhotoSize::Thumbnail));
-		if ((good && !_goodLoaded) || widthChanged) {
-			_goodLoaded = good;
-			_pix = QImage();
-			if (_goodLoaded) {
-				setPixFrom(_dataMedia->image(Data::PhotoSize::Large)
-					? _dataMedia->image(Data::PhotoSize::Large)
-					: _dataMedia->image(Data::PhotoSize::Thumbnail));
-			} else if (const auto small = _spoiler
-				? nullptr
-				: _dataMedia->image(Data::PhotoSize::Small)) {
-				setPixFrom(small);
-			} else if (const auto blurred = _dataMedia->thumbnailInline()) {
-				setPixFrom(blurred);
-			}
-		}
-	}
+	validatePix();
 
 	if (_pix.isNull()) {
 		p.fillRect(0, 0, _width, _height, st::overviewPhotoBg);
@@ -417,14 +513,92 @@ void Photo::paint(Painter &p, const QRect &clip, TextSelection selection, const
 	paintCheckbox(p, { checkLeft, checkTop }, selected, context);
 }
 
-void Photo::setPixFrom(not_null<Image*> image) {
-	Expects(_width > 0 && _height > 0);
+void Photo::validatePix() {
+	const auto widthChanged = (_pix.width()
+		!= (_width * style::DevicePixelRatio()));
+	if (_goodLoaded && !widthChanged) {
+		return;
+	}
+	ensureDataMediaCreated();
+	const auto good = !_spoiler
+		&& (_dataMedia->loaded()
+			|| _dataMedia->image(Data::PhotoSize::Thumbnail));
+	if (!good && !widthChanged) {
+		return;
+	} else if (_pixPreparing.alive()
+		&& (_pixPreparingWidth == _width)
+		&& (_pixPreparingGood || !good)) {
+		return;
+	}
+	_pixPreparing = base::binary_guard();
+	if (good) {
+		auto cached = PreparedFrames::Instance().find(
+			_data->id,
+			false,
+			QSize(_width, _height) * style::DevicePixelRatio());
+		if (!cached.isNull()) {
+			setPix(std::move(cached), true);
+			return;
+		}
+	}
+	const auto large = good
+		? _dataMedia->image(Data::PhotoSize::Large)
+		: nullptr;
+	const auto image = large
+		? large
+		: good
+		? _dataMedia->image(Data::PhotoSize::Thumbnail)
+		: _spoiler
+		? nullptr
+		: _dataMedia->image(Data::PhotoSize::Small);
+	if (image) {
+		// Only frames from the full photo are shared through the cache.
+		preparePix(image, good, (large != nullptr));
+	}
+	if (!widthChanged) {
+		return;
+	}
 
-	auto img = image->original();
-	if (!_goodLoaded) {
-		img = Images::Blur(std::move(img));
+	// Show something right away, the prepared frame will replace it.
+	auto placeholder = QImage();
+	if (image && !_pix.isNull()) {
+		placeholder = ScaleMediaFramePlaceholder(_pix, _width, _height);
+	} else if (const auto blurred = _dataMedia->thumbnailInline()) {
+		placeholder = CropMediaFrame(
+			Images::Blur(blurred->original()),
+			_width,
+			_height);
+	}
+	if (image) {
+		_pix = std::move(placeholder);
+		_goodLoaded = false;
+	} else {
+		setPix(std::move(placeholder), false);
 	}
-	_pix = CropMediaFrame(std::move(img), _width, _height);
+}
+
+void Photo::preparePix(not_null<Image*> image, bool good, bool cache) {
+	Expects(_width > 0 && _height > 0);
+
+	_pixPreparingWidth = _width;
+	_pixPreparingGood = good;
+	_pixPreparing = PrepareMediaFrameAsync(
+		image->original(),
+		_width,
+		_height,
+		!good,
+		[=](QImage frame) {
+			if (cache) {
+				PreparedFrames::Instance().insert(_data->id, false, frame);
+			}
+			setPix(std::move(frame), good);
+			delegate()->repaintItem(this);
+		});
+}
+
+void Photo::setPix(QImage pix, bool good) {
+	_pix = std::move(pix);
+	_goodLoaded = good;
 
 	// In case we have inline thumbnail we can unload all images and we still
 	// won't get a blank image in the media viewer when the photo is opened.
@@ -474,6 +648,7 @@ void Photo::itemDataChanged() {
 
 void Photo::clearHeavyPart() {
 	_dataMedia = nullptr;
+	_pixPreparing = base::binary_guard();
 }
 
 TextState Photo::getState(
@@ -572,17 +747,7 @@ void Video::paint(
 	const auto radial = isRadialAnimation();
 	const auto radialOpacity = radial ? _radial->opacity() : 0.;
 
-	if ((blurred || thumbnail || good)
-		&& ((_pix.width() != _width * style::DevicePixelRatio())
-			|| (_pixBlurred && (thumbnail || good)))) {
-		auto img = good
-			? good->original()
-			: thumbnail
-			? thumbnail->original()
-			: Images::Blur(blurred->original());
-		_pix = CropMediaFrame(std::move(img), _width, _height);
-		_pixBlurred = !(thumbnail || good);
-	}
+	validatePix(blurred, thumbnail, good);
 
 	if (_pix.isNull()) {
 		p.fillRect(0, 0, _width, _height, st::overviewPhotoBg);
@@ -679,6 +844,71 @@ void Video::paint(
 	paintCheckbox(p, { checkLeft, checkTop }, selected, context);
 }
 
+void Video::validatePix(Image *blurred, Image *thumbnail, Image *good) {
+	const auto widthChanged = (_pix.width()
+		!= (_width * style::DevicePixelRatio()));
+	const auto better = (thumbnail || good);
+	if (!blurred && !better) {
+		return;
+	} else if (!widthChanged && !(_pixBlurred && better)) {
+		return;
+	}
+	if (better) {
+		if (_pixPreparing.alive()
+			&& (_pixPreparingWidth == _width)
+			&& (_pixPreparingGood || !good)) {
+			return;
+		}
+		_pixPreparing = base::binary_guard();
+		if (good) {
+			auto cached = PreparedFrames::Instance().find(
+				_videoCover ? _videoCover->id : _data->id,
+				!_videoCover,
+				QSize(_width, _height) * style::DevicePixelRatio());
+			if (!cached.isNull()) {
+				_pix = std::move(cached);
+				_pixBlurred = false;
+				return;
+			}
+		}
+		preparePix(good ? good : thumbnail, (good != nullptr));
+	}
+	if (!widthChanged) {
+		return;
+	}
+
+	// Show something right away, the prepared frame will replace it.
+	_pix = (better && !_pix.isNull())
+		? ScaleMediaFramePlaceholder(_pix, _width, _height)
+		: blurred
+		? CropMediaFrame(Images::Blur(blurred->original()), _width, _height)
+		: QImage();
+	_pixBlurred = true;
+}
+
+void Video::preparePix(not_null<Image*> image, bool good) {
+	Expects(_width > 0 && _height > 0);
+
+	_pixPreparingWidth = _width;
+	_pixPreparingGood = good;
+	_pixPreparing = PrepareMediaFrameAsync(
+		image->original(),
+		_width,
+		_height,
+		false,
+		[=](QImage frame) {
+			if (good) {
+				PreparedFrames::Instance().insert(
+					_videoCover ? _videoCover->id : _data->id,
+					!_videoCover,
+					frame);
+			}
+			_pix = std::move(frame);
+			_pixBlurred = false;
+			delegate()->repaintItem(this);
+		});
+}
+
 void Video::ensureDataMediaCreated() const {
 	if (_dataMedia && (!_videoCover || _videoCoverMedia)) {
 		return;
@@ -722,6 +952,7 @@ void Video::itemDataChanged() {
 
 void Video::clearHeavyPart() {
 	_dataMedia = nullptr;
+	_pixPreparing = base::binary_guard();
 }
 
 float64 Video::dataProgress() const {
@@ -9,6 +9,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "layout/layout_item_base.h"
 #include "layout/layout_document_generic_preview.h"
+#include "base/binary_guard.h"
 #include "media/clip/media_clip_reader.h"
 #include "core/click_handler_types.h"
 #include "ui/effects/animations.h"
@@ -219,7 +220,9 @@ public:
 
 private:
 	void ensureDataMediaCreated() const;
-	void setPixFrom(not_null<Image*> image);
+	void validatePix();
+	void preparePix(not_null<Image*> image, bool good, bool cache);
+	void setPix(QImage pix, bool good);
 	[[nodiscard]] ClickHandlerPtr makeOpenPhotoHandler();
 	void clearSpoiler();
 
@@ -229,6 +232,9 @@ private:
 
 	QImage _pix;
 	QImage _hiddenBgCache;
+	base::binary_guard _pixPreparing;
+	int _pixPreparingWidth = 0;
+	bool _pixPreparingGood : 1 = false;
 	bool _goodLoaded : 1 = false;
 	bool _sensitiveSpoiler : 1 = false;
 	bool _story : 1 = false;
@@ -335,6 +341,8 @@ protected:
 private:
 	void ensureDataMediaCreated() const;
 	void updateStatusText();
+	void validatePix(Image *blurred, Image *thumbnail, Image *good);
+	void preparePix(not_null<Image*> image, bool good);
 
 	const not_null<DocumentData*> _data;
 	PhotoData *_videoCover = nullptr;
@@ -347,6 +355,9 @@ private:
 
 	QImage _pix;
 	QImage _hiddenBgCache;
+	base::binary_guard _pixPreparing;
+	int _pixPreparingWidth = 0;
+	bool _pixPreparingGood : 1 = false;
 	bool _pixBlurred : 1 = true;
 	bool _sensitiveSpoiler : 1 = false;
 	bool _story : 1 = false;
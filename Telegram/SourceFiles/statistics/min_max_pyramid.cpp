@@ -0,0 +1,71 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "statistics/min_max_pyramid.h"
+
+namespace Statistic {
+namespace {
+
+// Short lines are drawn point by point anyway.
+constexpr auto kMinArraySize = size_t(256);
+
+} // namespace
+
+MinMaxPyramid::MinMaxPyramid(const std::vector<ChartValue> &array) {
+	if (array.size() < kMinArraySize) {
+		return;
+	}
+	const auto pick = [&](int a, int b, bool max) {
+		return (a < 0)
+			? b
+			: (b < 0)
+			? a
+			: ((array[b] > array[a]) == max && array[b] != array[a])
+			? b
+			: a;
+	};
+	const auto merge = [&](Bucket a, Bucket b) {
+		return Bucket{
+			.min = pick(a.min, b.min, false),
+			.max = pick(a.max, b.max, true),
+		};
+	};
+	const auto point = [&](int i) {
+		return (i < int(array.size()) && array[i] >= 0)
+			? Bucket{ i, i }
+			: Bucket();
+	};
+
+	auto level = std::vector<Bucket>((array.size() + 1) / 2);
+	for (auto b = 0; b != int(level.size()); ++b) {
+		level[b] = merge(point(2 * b), point(2 * b + 1));
+	}
+	while (level.size() > 1) {
+		auto next = std::vector<Bucket>((level.size() + 1) / 2);
+		for (auto b = 0; b != int(next.size()); ++b) {
+			const auto second = 2 * b + 1;
+			next[b] = (second < int(level.size()))
+				? merge(level[2 * b], level[second])
+				: level[2 * b];
+		}
+		_levels.push_back(std::move(level));
+		level = std::move(next);
+	}
+	_levels.push_back(std::move(level));
+}
+
+int MinMaxPyramid::chooseLevel(int count, int pixels) const {
+	// Use the largest buckets that still give at least one per pixel.
+	auto result = -1;
+	while (result + 1 < int(_levels.size())
+		&& count / (2 << (result + 1)) >= pixels) {
+		++result;
+	}
+	return result;
+}
+
+} // namespace Statistic
@@ -0,0 +1,69 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "statistics/statistics_types.h"
+
+namespace Statistic {
+
+// Levels of buckets of 2, 4, 8, ... points with the indices of their
+// min and max values, so that a long line can be drawn with a couple
+// of points for each pixel and still look the same.
+class MinMaxPyramid final {
+public:
+	MinMaxPyramid() = default;
+	explicit MinMaxPyramid(const std::vector<ChartValue> &array);
+
+	// Calls callback(index) in ascending order for the points that are
+	// enough to draw [from, to] on the given width in pixels.
+	// Bucket points have non-negative values, others are not checked.
+	template <typename Callback>
+	void enumerate(int from, int to, int pixels, Callback &&callback) const;
+
+private:
+	struct Bucket {
+		int min = -1;
+		int max = -1;
+	};
+
+	[[nodiscard]] int chooseLevel(int count, int pixels) const;
+
+	std::vector<std::vector<Bucket>> _levels;
+
+};
+
+template <typename Callback>
+void MinMaxPyramid::enumerate(
+		int from,
+		int to,
+		int pixels,
+		Callback &&callback) const {
+	const auto level = chooseLevel(to - from + 1, pixels);
+	if (level < 0) {
+		for (auto i = from; i <= to; ++i) {
+			callback(i);
+		}
+		return;
+	}
+	const auto size = (2 << level);
+	const auto &buckets = _levels[level];
+	const auto till = std::min(to / size + 1, int(buckets.size()));
+	for (auto b = from / size; b < till; ++b) {
+		const auto [min, max] = buckets[b];
+		const auto first = std::min(min, max);
+		const auto second = std::max(min, max);
+		if (first >= 0) {
+			callback(first);
+		}
+		if (second != first) {
+			callback(second);
+		}
+	}
+}
+
+} // namespace Statistic
@@ -35,9 +35,11 @@ void PaintChartLine(
 
 	const auto ratio = ratios.ratio(line.id);
 
-	for (auto i = localStart; i <= localEnd; i++) {
+	// Only the min / max points of each pixel are visible anyway.
+	const auto pixels = std::max(c.rect.width(), 1);
+	line.pyramid.enumerate(localStart, localEnd, pixels, [&](int i) {
 		if (line.y[i] < 0) {
-			continue;
+			return;
 		}
 		const auto xPoint = c.rect.width()
 			* ((c.chartData.xPercentage[i] - c.xPercentageLimits.min)
@@ -46,7 +48,7 @@ void PaintChartLine(
 			/ float64(c.heightLimits.max - c.heightLimits.min);
 		const auto yPoint = (1. - yPercentage) * c.rect.height();
 		chartPoints << QPointF(xPoint, yPoint);
-	}
+	});
 	p.setPen(QPen(
 		line.color,
 		c.footer ? st::lineWidth : st::statisticsChartLineWidth));
@@ -21,7 +21,7 @@ namespace {
 
 constexpr auto kKillSessionTimeout = 15 * crl::time(1000);
 constexpr auto kStartWaitedInSession = 4 * kDownloadPartSize;
-constexpr auto kMaxWaitedInSession = 16 * kDownloadPartSize;
+constexpr auto kMaxWaitedInSession = 32 * kDownloadPartSize;
 constexpr auto kStartSessionsCount = 1;
 constexpr auto kMaxSessionsCount = 8;
 constexpr auto kMaxTrackedSessionRemoves = 64;
@@ -30,51 +30,56 @@ constexpr auto kRetryAddSessionSuccesses = 3;
 constexpr auto kMaxTrackedSuccesses = kRetryAddSessionSuccesses
 	* kMaxTrackedSessionRemoves;
 constexpr auto kRemoveSessionAfterTimeouts = 4;
-constexpr auto kResetDownloadPrioritiesTimeout = crl::time(200);
 constexpr auto kBadRequestDurationThreshold = 8 * crl::time(1000);
 
+// Minimal request duration is used as the round trip time estimate,
+// it is forgotten if not confirmed for some time.
+constexpr auto kMinDurationLifetime = 10 * crl::time(1000);
+
+// Bandwidth estimate is a max-filter of samples, slowly decaying.
+constexpr auto kBandwidthDecay = 0.95;
+
+// We keep in flight twice the estimated bandwidth-delay product.
+constexpr auto kWaitedAmountGain = 2.;
+
+// After adding a session we check that it increased the throughput.
+constexpr auto kAddedSessionCheckDelay = 5 * crl::time(1000);
+constexpr auto kAddedSessionMinGain = 1.1;
+
 // Each (session remove by timeouts) we wait for time:
 // kRetryAddSessionTimeout * max(removesCount, kMaxTrackedSessionRemoves)
 // and for successes in all remaining sessions:
 // kRetryAddSessionSuccesses * max(removesCount, kMaxTrackedSessionRemoves)
 
+template <typename Sessions>
+[[nodiscard]] float64 TotalBytesPerMs(const Sessions &sessions) {
+	auto result = 0.;
+	for (const auto &session : sessions) {
+		result += session.bytesPerMs;
+	}
+	return result;
+}
+
 } // namespace
 
 void DownloadManagerMtproto::Queue::enqueue(
 		not_null<Task*> task,
 		int priority) {
-	const auto position = ranges::find_if(_tasks, [&](const Enqueued &task) {
-		return task.priority <= priority;
-	}) - begin(_tasks);
-	const auto now = ranges::find(_tasks, task, &Enqueued::task);
-	const auto i = [&] {
-		if (now != end(_tasks)) {
-			(now->priority = priority);
-			return now;
-		}
-		_tasks.push_back({ task, priority });
-		return end(_tasks) - 1;
-	}();
-	const auto j = begin(_tasks) + position;
-	if (j < i) {
-		std::rotate(j, i, i + 1);
-	} else if (j > i + 1) {
-		std::rotate(i, i + 1, j);
-	}
+	// Re-enqueued task goes before all the tasks of the same priority.
+	remove(task);
+	const auto i = _tasks.insert(Enqueued{
+		.task = task,
+		.priority = priority,
+		.sequence = ++_sequence,
+	}).first;
+	_positions.emplace(task.get(), i);
 }
 
 void DownloadManagerMtproto::Queue::remove(not_null<Task*> task) {
-	_tasks.erase(ranges::remove(_tasks, task, &Enqueued::task), end(_tasks));
-}
-
-void DownloadManagerMtproto::Queue::resetGeneration() {
-	const auto from = ranges::find(_tasks, 0, &Enqueued::priority);
-	for (auto &task : ranges::make_subrange(from, end(_tasks))) {
-		if (task.priority) {
-			Assert(task.priority == -1);
-			break;
-		}
-		task.priority = -1;
+	const auto i = _positions.find(task.get());
+	if (i != end(_positions)) {
+		_tasks.erase(i->second);
+		_positions.erase(i);
 	}
 }
 
@@ -87,20 +92,16 @@ auto DownloadManagerMtproto::Queue::nextTask(bool onlyHighestPriority) const
 	if (_tasks.empty()) {
 		return nullptr;
 	}
-	const auto highestPriority = _tasks.front().priority;
-	const auto notHighestPriority = [&](const Enqueued &enqueued) {
-		return (enqueued.priority != highestPriority);
-	};
-	const auto till = (onlyHighestPriority && highestPriority > 0)
-		? ranges::find_if(_tasks, notHighestPriority)
-		: end(_tasks);
-	const auto readyToRequest = [&](const Enqueued &enqueued) {
-		return enqueued.task->readyToRequest();
-	};
-	const auto first = ranges::find_if(
-		ranges::make_subrange(begin(_tasks), till),
-		readyToRequest);
-	return (first != till) ? first->task.get() : nullptr;
+	const auto highestPriority = _tasks.begin()->priority;
+	const auto limited = (onlyHighestPriority && highestPriority > 0);
+	for (const auto &enqueued : _tasks) {
+		if (limited && enqueued.priority != highestPriority) {
+			break;
+		} else if (enqueued.task->readyToRequest()) {
+			return enqueued.task.get();
+		}
+	}
+	return nullptr;
 }
 
 void DownloadManagerMtproto::Queue::removeSession(int index) {
@@ -119,7 +120,6 @@ DownloadManagerMtproto::DcBalanceData::DcBalanceData()
 
 DownloadManagerMtproto::DownloadManagerMtproto(not_null<ApiWrap*> api)
 : _api(api)
-, _resetGenerationTimer([=] { resetGeneration(); })
 , _killSessionsTimer([=] { killSessions(); }) {
 	_api->instance().restartsByTimeout(
 	) | rpl::filter([](MTP::ShiftedDcId shiftedDcId) {
@@ -139,9 +139,6 @@ void DownloadManagerMtproto::enqueue(not_null<Task*> task, int priority) {
 	const auto dcId = task->dcId();
 	auto &queue = _queues[dcId];
 	queue.enqueue(task, priority);
-	if (!_resetGenerationTimer.isActive()) {
-		_resetGenerationTimer.callOnce(kResetDownloadPrioritiesTimeout);
-	}
 	checkSendNext(dcId, queue);
 }
 
@@ -152,13 +149,6 @@ void DownloadManagerMtproto::remove(not_null<Task*> task) {
 	checkSendNext(dcId, queue);
 }
 
-void DownloadManagerMtproto::resetGeneration() {
-	_resetGenerationTimer.cancel();
-	for (auto &[dcId, queue] : _queues) {
-		queue.resetGeneration();
-	}
-}
-
 void DownloadManagerMtproto::checkSendNext() {
 	for (auto &[dcId, queue] : _queues) {
 		if (queue.empty()) {
@@ -259,15 +249,47 @@ void DownloadManagerMtproto::requestSucceeded(
 		});
 		return;
 	}
+
+	// All the bytes requested before this one were received during
+	// its duration, so this is a (lower bound) bandwidth sample.
+	const auto now = crl::now();
+	const auto sampleDuration = std::max(duration, crl::time(1));
+	if (!data.minDuration
+		|| sampleDuration <= data.minDuration
+		|| now - data.minDurationWhen >= kMinDurationLifetime) {
+		data.minDuration = sampleDuration;
+		data.minDurationWhen = now;
+	}
+	data.bytesPerMs = std::max(
+		amountAtRequestStart / float64(sampleDuration),
+		data.bytesPerMs * kBandwidthDecay);
+
+	const auto product = data.bytesPerMs * data.minDuration;
+	const auto targetParts = int(std::ceil(
+		product * kWaitedAmountGain / kDownloadPartSize));
+	const auto target = std::clamp(
+		targetParts * kDownloadPartSize,
+		kStartWaitedInSession,
+		kMaxWaitedInSession);
 	if (amountAtRequestStart == data.maxWaitedAmount
-		&& data.maxWaitedAmount < kMaxWaitedInSession) {
-		data.maxWaitedAmount = std::min(
-			data.maxWaitedAmount + kDownloadPartSize,
-			kMaxWaitedInSession);
+		&& data.maxWaitedAmount < target) {
+		data.maxWaitedAmount += kDownloadPartSize;
 		DEBUG_LOG(("Download (%1,%2) increased max waited amount %3."
 			).arg(dcId
 			).arg(index
 			).arg(data.maxWaitedAmount));
+	} else if (data.maxWaitedAmount > target) {
+		data.maxWaitedAmount -= kDownloadPartSize;
+		DEBUG_LOG(("Download (%1,%2) decreased max waited amount %3."
+			).arg(dcId
+			).arg(index
+			).arg(data.maxWaitedAmount));
+	}
+	if (dc.lastSessionAdd
+		&& now - dc.lastSessionAdd >= kAddedSessionCheckDelay) {
+		crl::on_main(this, [=] {
+			checkAddedSessionHelped(dcId);
+		});
 	}
 	data.successes = std::min(data.successes + 1, kMaxTrackedSuccesses);
 	const auto notEnough = ranges::any_of(
@@ -286,11 +308,14 @@ void DownloadManagerMtproto::requestSucceeded(
 	} else if (dc.sessions.size() == kMaxSessionsCount) {
 		return;
 	}
-	const auto now = crl::now();
 	const auto delay = (dc.sessionRemoveTimes + 1) * kRetryAddSessionTimeout;
 	if (dc.lastSessionRemove && now < dc.lastSessionRemove + delay) {
 		return;
+	} else if (dc.lastSessionAdd) {
+		return;
 	}
+	dc.bytesPerMsBeforeAdd = TotalBytesPerMs(dc.sessions);
+	dc.lastSessionAdd = now;
 	dc.sessions.emplace_back();
 	DEBUG_LOG(("Download (%1,%2) adding, now sessions: %3"
 		).arg(dcId
@@ -309,6 +334,48 @@ int DownloadManagerMtproto::chooseSessionIndex(MTP::DcId dcId) const {
 	return (j - begin(sessions));
 }
 
+auto DownloadManagerMtproto::sessionEstimates() const
+-> std::vector<DownloadSessionEstimate> {
+	auto result = std::vector<DownloadSessionEstimate>();
+	for (const auto &[dcId, dc] : _balanceData) {
+		for (auto i = 0; i != int(dc.sessions.size()); ++i) {
+			const auto &session = dc.sessions[i];
+			result.push_back({
+				.dcId = dcId,
+				.index = i,
+				.requested = session.requested,
+				.maxWaitedAmount = session.maxWaitedAmount,
+				.minDuration = session.minDuration,
+				.bytesPerSecond = int64(session.bytesPerMs * 1000.),
+			});
+		}
+	}
+	return result;
+}
+
+void DownloadManagerMtproto::checkAddedSessionHelped(MTP::DcId dcId) {
+	const auto i = _balanceData.find(dcId);
+	if (i == end(_balanceData)) {
+		return;
+	}
+	auto &dc = i->second;
+	if (!dc.lastSessionAdd
+		|| crl::now() - dc.lastSessionAdd < kAddedSessionCheckDelay) {
+		return;
+	}
+	dc.lastSessionAdd = 0;
+	const auto was = base::take(dc.bytesPerMsBeforeAdd);
+	const auto now = TotalBytesPerMs(dc.sessions);
+	DEBUG_LOG(("Download (%1) added session check, speed: %2 -> %3"
+		).arg(dcId
+		).arg(int64(was * 1000.)
+		).arg(int64(now * 1000.)));
+	if (now < was * kAddedSessionMinGain
+		&& dc.sessions.size() > kStartSessionsCount) {
+		removeSession(dcId);
+	}
+}
+
 void DownloadManagerMtproto::sessionTimedOut(MTP::DcId dcId, int index) {
 	const auto i = _balanceData.find(dcId);
 	if (i == end(_balanceData)) {
@@ -687,19 +754,18 @@ void DownloadMtprotoTask::cdnPartLoaded(const MTPupload_CdnFile &result, mtpRequ
 		Expects(key.size() == MTP::CTRState::KeySize);
 		Expects(iv.size() == MTP::CTRState::IvecSize);
 
-		auto state = MTP::CTRState();
-		auto ivec = bytes::make_span(state.ivec);
-		std::copy(iv.begin(), iv.end(), ivec.begin());
+		auto ivec = bytes::array<MTP::CTRState::IvecSize>();
+		bytes::copy(ivec, iv);
 
 		auto counterOffset = static_cast<uint32>(requestData.offset >> 4);
-		state.ivec[15] = static_cast<uchar>(counterOffset & 0xFF);
-		state.ivec[14] = static_cast<uchar>((counterOffset >> 8) & 0xFF);
-		state.ivec[13] = static_cast<uchar>((counterOffset >> 16) & 0xFF);
-		state.ivec[12] = static_cast<uchar>((counterOffset >> 24) & 0xFF);
+		ivec[15] = static_cast<bytes::type>(counterOffset & 0xFF);
+		ivec[14] = static_cast<bytes::type>((counterOffset >> 8) & 0xFF);
+		ivec[13] = static_cast<bytes::type>((counterOffset >> 16) & 0xFF);
+		ivec[12] = static_cast<bytes::type>((counterOffset >> 24) & 0xFF);
 
 		auto decryptInPlace = data.vbytes().v;
 		auto buffer = bytes::make_detached_span(decryptInPlace);
-		MTP::aesCtrEncrypt(buffer, key.data(), &state);
+		MTP::CTRCipher(key, ivec).encrypt(buffer);
 
 		switch (checkCdnFileHash(requestData.offset, buffer)) {
 		case CheckCdnHashResult::NoHash: {
@@ -27,6 +27,15 @@ constexpr auto kDownloadPartSize = 128 * 1024;
 
 class DownloadMtprotoTask;
 
+struct DownloadSessionEstimate {
+	MTP::DcId dcId = 0;
+	int index = 0;
+	int requested = 0;
+	int maxWaitedAmount = 0;
+	crl::time minDuration = 0;
+	int64 bytesPerSecond = 0;
+};
+
 class DownloadManagerMtproto final : public base::has_weak_ptr {
 public:
 	using Task = DownloadMtprotoTask;
@@ -57,6 +66,9 @@ public:
 	void checkSendNextAfterSuccess(MTP::DcId dcId);
 	[[nodiscard]] int chooseSessionIndex(MTP::DcId dcId) const;
 
+	[[nodiscard]] auto sessionEstimates() const
+		-> std::vector<DownloadSessionEstimate>;
+
 	void notifyNonPremiumDelay(DocumentId id) {
 		_nonPremiumDelays.fire_copy(id);
 	}
@@ -69,17 +81,27 @@ private:
 	public:
 		void enqueue(not_null<Task*> task, int priority);
 		void remove(not_null<Task*> task);
-		void resetGeneration();
 		[[nodiscard]] bool empty() const;
 		[[nodiscard]] Task *nextTask(bool onlyHighestPriority) const;
 		void removeSession(int index);
 
 	private:
+		// Higher priority first, then the most recently enqueued first,
+		// so older tasks of the same priority go after the new ones.
 		struct Enqueued {
 			not_null<Task*> task;
 			int priority = 0;
+			uint64 sequence = 0;
+
+			inline bool operator<(const Enqueued &other) const {
+				return (priority != other.priority)
+					? (priority > other.priority)
+					: (sequence > other.sequence);
+			}
 		};
-		std::vector<Enqueued> _tasks;
+		std::set<Enqueued> _tasks;
+		std::unordered_map<Task*, std::set<Enqueued>::iterator> _positions;
+		uint64 _sequence = 0;
 
 	};
 	struct DcSessionBalanceData {
@@ -88,6 +110,11 @@ private:
 		int requested = 0;
 		int successes = 0; // Since last timeout in this dc in any session.
 		int maxWaitedAmount = 0;
+
+		// Bandwidth-delay product estimation.
+		crl::time minDuration = 0;
+		crl::time minDurationWhen = 0;
+		float64 bytesPerMs = 0.;
 	};
 	struct DcBalanceData {
 		DcBalanceData();
@@ -98,6 +125,8 @@ private:
 		int sessionRemoveTimes = 0;
 		int timeouts = 0; // Since all sessions had successes >= required.
 		int totalRequested = 0;
+		crl::time lastSessionAdd = 0;
+		float64 bytesPerMsBeforeAdd = 0.;
 	};
 
 	void checkSendNext();
@@ -109,8 +138,8 @@ private:
 	void killSessions();
 	void killSessions(MTP::DcId dcId);
 
-	void resetGeneration();
 	void sessionTimedOut(MTP::DcId dcId, int index);
+	void checkAddedSessionHelped(MTP::DcId dcId);
 	void removeSession(MTP::DcId dcId);
 
 	const not_null<ApiWrap*> _api;
@@ -119,7 +148,6 @@ private:
 	rpl::event_stream<DocumentId> _nonPremiumDelays;
 
 	base::flat_map<MTP::DcId, DcBalanceData> _balanceData;
-	base::Timer _resetGenerationTimer;
 
 	base::flat_map<MTP::DcId, crl::time> _killSessionsWhen;
 	base::Timer _killSessionsTimer;
@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "api/api_send_progress.h"
 #include "storage/localimageloader.h"
 #include "storage/file_download.h"
+#include "storage/file_upload_reader.h"
 #include "data/data_document.h"
 #include "data/data_document_media.h"
 #include "data/data_photo.h"
@@ -87,7 +88,7 @@ struct Uploader::Entry {
 
 	HashMd5 md5Hash;
 
-	std::unique_ptr<QFile> docFile;
+	std::unique_ptr<UploadPartsReader> docReader;
 	int64 docSize = 0;
 	int64 docSentSize = 0;
 	int docPartSize = 0;
@@ -95,6 +96,10 @@ struct Uploader::Entry {
 	ushort docPartsCount = 0;
 	ushort docPartsWaiting = 0;
 
+	// Last parts counted in UploadThrottleStats.
+	int docPartWaitedOnDisk = -1;
+	int docPartWaitedOnNetwork = -1;
+
 };
 
 struct Uploader::Request {
@@ -410,7 +415,32 @@ void Uploader::stopSessions() {
 	}
 }
 
+bool Uploader::docPartReady(not_null<Entry*> entry) {
+	if (!entry->file->content.isEmpty()) {
+		return true;
+	} else if (!entry->docReader) {
+		const auto computeMd5 = (entry->docSize <= kUseBigFilesFrom);
+		entry->docReader = std::make_unique<UploadPartsReader>(
+			entry->file->filepath,
+			entry->docSize,
+			entry->docPartSize,
+			entry->docPartsCount,
+			computeMd5,
+			[=] {
+				if (!_nextTimer.isActive()) {
+					maybeSend();
+				}
+			});
+	}
+	return entry->docReader->failed()
+		|| (entry->docReader->readyCount() > 0);
+}
+
 QByteArray Uploader::readDocPart(not_null<Entry*> entry) {
+	if (entry->docReader) {
+		// Sizes and md5 are handled by the reader.
+		return entry->docReader->takePart();
+	}
 	const auto checked = [&](QByteArray result) {
 		if ((entry->file->type == SendMediaType::File
 			|| entry->file->type == SendMediaType::ThemeFile
@@ -427,18 +457,9 @@ QByteArray Uploader::readDocPart(not_null<Entry*> entry) {
 		}
 		return result;
 	};
-	auto &content = entry->file->content;
-	if (!content.isEmpty()) {
-		const auto offset = entry->docPartsSent * entry->docPartSize;
-		return checked(content.mid(offset, entry->docPartSize));
-	} else if (!entry->docFile) {
-		const auto filepath = entry->file->filepath;
-		entry->docFile = std::make_unique<QFile>(filepath);
-		if (!entry->docFile->open(QIODevice::ReadOnly)) {
-			return QByteArray();
-		}
-	}
-	return checked(entry->docFile->read(entry->docPartSize));
+	const auto &content = entry->file->content;
+	const auto offset = entry->docPartsSent * entry->docPartSize;
+	return checked(content.mid(offset, entry->docPartSize));
 }
 
 bool Uploader::canAddDcIndex() const {
@@ -554,11 +575,24 @@ auto Uploader::sendDocPart(not_null<Entry*> entry, uchar dcIndex)
 	const auto alreadySent = _sentPerDcIndex[dcIndex];
 	const auto willProbablyBeSent = entry->docPartSize;
 	if (alreadySent + willProbablyBeSent > kMaxUploadPerSession) {
+		if (entry->docReader
+			&& entry->docReader->readyCount() > 0
+			&& entry->docPartWaitedOnNetwork != entry->docPartsSent) {
+			entry->docPartWaitedOnNetwork = entry->docPartsSent;
+			++_throttleStats.partsWaitingOnNetwork;
+		}
 		return SendResult::DcIndexFull;
 	}
 
 	Assert(entry->docPartsSent < entry->docPartsCount);
 
+	if (!docPartReady(entry)) {
+		if (entry->docPartWaitedOnDisk != entry->docPartsSent) {
+			entry->docPartWaitedOnDisk = entry->docPartsSent;
+			++_throttleStats.partsWaitingOnDisk;
+		}
+		return SendResult::WaitingForRead;
+	}
 	const auto partBytes = readDocPart(entry);
 	if (partBytes.isEmpty()) {
 		failed(itemId);
@@ -645,7 +679,8 @@ void Uploader::maybeSend() {
 				return;
 			}
 			const auto result = sendPart(entry, dcIndex);
-			if (result == SendResult::DcIndexFull) {
+			if (result == SendResult::DcIndexFull
+				|| result == SendResult::WaitingForRead) {
 				return;
 			} else if (result == SendResult::Success) {
 				break;
@@ -725,7 +760,7 @@ Uploader::Request Uploader::finishRequest(mtpRequestId requestId) {
 }
 
 void Uploader::partLoaded(const MTPBool &result, mtpRequestId requestId) {
-	const auto request = finishRequest(requestId);
+	auto request = finishRequest(requestId);
 
 	const auto bytes = int(request.bytes.size());
 	const auto itemId = request.itemId;
@@ -772,6 +807,9 @@ void Uploader::partLoaded(const MTPBool &result, mtpRequestId requestId) {
 	if (request.docPart) {
 		--entry.docPartsWaiting;
 		entry.docSentSize += bytes;
+		if (entry.docReader) {
+			entry.docReader->recycle(base::take(request.bytes));
+		}
 	} else {
 		--entry.partsWaiting;
 		entry.sentSize += bytes;
@@ -897,7 +935,15 @@ void Uploader::finishFront() {
 		|| entry.file->type == SendMediaType::Audio
 		|| entry.file->type == SendMediaType::Round) {
 		QByteArray docMd5(32, Qt::Uninitialized);
-		hashMd5Hex(entry.md5Hash.result(), docMd5.data());
+		hashMd5Hex(
+			(entry.docReader
+				? entry.docReader->md5()
+				: entry.md5Hash.result()),
+			docMd5.data());
+
+		DEBUG_LOG(("Uploader: Parts waiting on disk %1, on network %2."
+			).arg(_throttleStats.partsWaitingOnDisk
+			).arg(_throttleStats.partsWaitingOnNetwork));
 
 		const auto file = (entry.docSize > kUseBigFilesFrom)
 			? MTP_inputFileBig(
@@ -48,6 +48,15 @@ struct UploadSecureDone {
 	int partsCount = 0;
 };
 
+// Each part is counted once, however many times it was polled.
+struct UploadThrottleStats {
+	// A network slot was free, but the next part was not read from disk.
+	int64 partsWaitingOnDisk = 0;
+
+	// A part was read from disk, but all sessions were full.
+	int64 partsWaitingOnNetwork = 0;
+};
+
 class Uploader final : public base::has_weak_ptr {
 public:
 	explicit Uploader(not_null<ApiWrap*> api);
@@ -97,6 +106,10 @@ public:
 		return _nonPremiumDelays.events();
 	}
 
+	[[nodiscard]] UploadThrottleStats throttleStats() const {
+		return _throttleStats;
+	}
+
 	void unpause();
 	void stopSessions();
 
@@ -108,6 +121,7 @@ private:
 		Success,
 		Failed,
 		DcIndexFull,
+		WaitingForRead,
 	};
 
 	void maybeSend();
@@ -123,6 +137,7 @@ private:
 	[[nodiscard]] auto sendSlicedPart(not_null<Entry*> entry, uchar dcIndex)
 		-> SendResult;
 	[[nodiscard]] QByteArray readDocPart(not_null<Entry*> entry);
+	[[nodiscard]] bool docPartReady(not_null<Entry*> entry);
 	void removeDcIndex();
 
 	template <typename Prepared>
@@ -175,6 +190,8 @@ private:
 	FullMsgId _pausedId;
 	base::Timer _nextTimer, _stopSessionsTimer;
 
+	UploadThrottleStats _throttleStats;
+
 	rpl::event_stream<UploadedMedia> _photoReady;
 	rpl::event_stream<UploadedMedia> _documentReady;
 	rpl::event_stream<UploadSecureDone> _secureReady;
@@ -0,0 +1,217 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "storage/file_upload_reader.h"
+
+#include <QtCore/QFile>
+
+namespace Storage {
+namespace {
+
+// How many bytes can be read ahead and not yet taken by the Uploader.
+constexpr auto kReadAheadBytes = 4 * 1024 * 1024;
+constexpr auto kReadAheadPartsMin = 2;
+
+} // namespace
+
+class UploadPartsReader::Loader final {
+public:
+	Loader(
+		crl::weak_on_queue<Loader> weak,
+		base::weak_ptr<UploadPartsReader> reader,
+		const QString &filepath,
+		int64 size,
+		int partSize,
+		int partsCount,
+		bool computeMd5);
+
+	void partTaken();
+	void recycle(QByteArray &&buffer);
+
+private:
+	void readNext();
+	void fail();
+
+	const crl::weak_on_queue<Loader> _weak;
+	const base::weak_ptr<UploadPartsReader> _reader;
+	const int64 _size = 0;
+	const int _partSize = 0;
+	const int _partsCount = 0;
+	const int _readAhead = 0;
+	const bool _computeMd5 = false;
+
+	QFile _file;
+	HashMd5 _md5Hash;
+	std::vector<QByteArray> _free;
+	int _partsRead = 0;
+	int _notTaken = 0;
+	bool _failed = false;
+
+};
+
+UploadPartsReader::Loader::Loader(
+	crl::weak_on_queue<Loader> weak,
+	base::weak_ptr<UploadPartsReader> reader,
+	const QString &filepath,
+	int64 size,
+	int partSize,
+	int partsCount,
+	bool computeMd5)
+: _weak(std::move(weak))
+, _reader(std::move(reader))
+, _size(size)
+, _partSize(partSize)
+, _partsCount(partsCount)
+, _readAhead(std::max(kReadAheadBytes / partSize, kReadAheadPartsMin))
+, _computeMd5(computeMd5)
+, _file(filepath) {
+	if (!_file.open(QIODevice::ReadOnly)) {
+		fail();
+		return;
+	}
+	readNext();
+}
+
+void UploadPartsReader::Loader::readNext() {
+	while (!_failed
+		&& _partsRead < _partsCount
+		&& _notTaken < _readAhead) {
+		const auto last = (_partsRead + 1 == _partsCount);
+		const auto size = last
+			? int(_size - int64(_partsRead) * _partSize)
+			: _partSize;
+		if (size <= 0 || size > _partSize) {
+			fail();
+			return;
+		}
+		auto buffer = QByteArray();
+		if (!_free.empty()) {
+			buffer = std::move(_free.back());
+			_free.pop_back();
+		}
+		buffer.resize(size);
+		if (_file.read(buffer.data(), size) != size) {
+			fail();
+			return;
+		}
+		if (_computeMd5) {
+			_md5Hash.feed(buffer.constData(), size);
+		}
+		++_partsRead;
+		++_notTaken;
+
+		auto md5 = std::optional<std::array<int32, 4>>();
+		if (last) {
+			_file.close();
+			if (_computeMd5) {
+				const auto result = _md5Hash.result();
+				md5.emplace();
+				std::copy(result, result + 4, md5->begin());
+			}
+		}
+		crl::on_main(_reader, [
+				reader = _reader,
+				md5,
+				bytes = std::move(buffer)
+		]() mutable {
+			const auto strong = reader.get();
+			if (md5) {
+				strong->md5Ready(*md5);
+			}
+			strong->partRead(std::move(bytes));
+		});
+	}
+}
+
+void UploadPartsReader::Loader::partTaken() {
+	Expects(_notTaken > 0);
+
+	--_notTaken;
+	readNext();
+}
+
+void UploadPartsReader::Loader::recycle(QByteArray &&buffer) {
+	// The buffer may still be referenced by a pending request copy.
+	if (buffer.isDetached()
+		&& buffer.capacity() >= _partSize
+		&& int(_free.size()) < _readAhead) {
+		_free.push_back(std::move(buffer));
+	}
+}
+
+void UploadPartsReader::Loader::fail() {
+	_failed = true;
+	_free.clear();
+	crl::on_main(_reader, [reader = _reader] {
+		reader.get()->readFailed();
+	});
+}
+
+UploadPartsReader::UploadPartsReader(
+	const QString &filepath,
+	int64 size,
+	int partSize,
+	int partsCount,
+	bool computeMd5,
+	Fn<void()> partsReady)
+: _partsReady(std::move(partsReady))
+, _loader(
+	base::make_weak(this),
+	filepath,
+	size,
+	partSize,
+	partsCount,
+	computeMd5) {
+}
+
+UploadPartsReader::~UploadPartsReader() = default;
+
+bool UploadPartsReader::failed() const {
+	return _failed;
+}
+
+int UploadPartsReader::readyCount() const {
+	return int(_ready.size());
+}
+
+QByteArray UploadPartsReader::takePart() {
+	if (_ready.empty()) {
+		return QByteArray();
+	}
+	auto result = std::move(_ready.front());
+	_ready.pop_front();
+	_loader.with([](Loader &loader) {
+		loader.partTaken();
+	});
+	return result;
+}
+
+void UploadPartsReader::recycle(QByteArray &&buffer) {
+	_loader.with([buffer = std::move(buffer)](Loader &loader) mutable {
+		loader.recycle(std::move(buffer));
+	});
+}
+
+const int32 *UploadPartsReader::md5() const {
+	return _md5.data();
+}
+
+void UploadPartsReader::partRead(QByteArray &&bytes) {
+	_ready.push_back(std::move(bytes));
+	_partsReady();
+}
+
+void UploadPartsReader::md5Ready(std::array<int32, 4> md5) {
+	_md5 = md5;
+}
+
+void UploadPartsReader::readFailed() {
+	_failed = true;
+	_partsReady();
+}
+
+} // namespace Storage
@@ -0,0 +1,58 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/weak_ptr.h"
+
+#include <crl/crl_object_on_queue.h>
+
+namespace Storage {
+
+// Reads document parts for the Uploader on a background queue,
+// keeping a bounded number of parts prefetched ahead of the sender.
+class UploadPartsReader final : public base::has_weak_ptr {
+public:
+	UploadPartsReader(
+		const QString &filepath,
+		int64 size,
+		int partSize,
+		int partsCount,
+		bool computeMd5,
+		Fn<void()> partsReady);
+	~UploadPartsReader();
+
+	[[nodiscard]] bool failed() const;
+	[[nodiscard]] int readyCount() const;
+
+	// Returns the next part in order or an empty array if not read yet.
+	[[nodiscard]] QByteArray takePart();
+
+	// Part buffers are returned here when the request using them finished.
+	void recycle(QByteArray &&buffer);
+
+	// Valid after the last part was taken.
+	[[nodiscard]] const int32 *md5() const;
+
+private:
+	class Loader;
+	friend class Loader;
+
+	void partRead(QByteArray &&bytes);
+	void md5Ready(std::array<int32, 4> md5);
+	void readFailed();
+
+	const Fn<void()> _partsReady;
+	std::deque<QByteArray> _ready;
+	std::array<int32, 4> _md5 = { { 0 } };
+	bool _failed = false;
+
+	crl::object_on_queue<Loader> _loader;
+
+};
+
+} // namespace Storage
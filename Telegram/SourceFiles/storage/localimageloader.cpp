@@ -14,6 +14,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_user.h"
 #include "core/file_utilities.h"
 #include "core/mime_type.h"
+#include "base/invoke_queued.h"
 #include "base/options.h"
 #include "base/unixtime.h"
 #include "base/random.h"
@@ -222,7 +223,8 @@ int PhotoSideLimit() {
 	return PhotoSideLimit(SendLargePhotos.value());
 }
 
-TaskQueue::TaskQueue(crl::time stopTimeoutMs) {
+TaskQueue::TaskQueue(crl::time stopTimeoutMs, int threads)
+: _threadsCount(std::max(threads, 1)) {
 	if (stopTimeoutMs > 0) {
 		_stopTimer = new QTimer(this);
 		connect(_stopTimer, SIGNAL(timeout()), this, SLOT(stop()));
@@ -235,7 +237,7 @@ TaskId TaskQueue::addTask(std::unique_ptr<Task> &&task) {
 	const auto result = task->id();
 	{
 		QMutexLocker lock(&_tasksToProcessMutex);
-		_tasksToProcess.push_back(std::move(task));
+		_tasksToProcess.push_back({ std::move(task), _tasksAdded++ });
 	}
 
 	wakeThread();
@@ -247,7 +249,7 @@ void TaskQueue::addTasks(std::vector<std::unique_ptr<Task>> &&tasks) {
 	{
 		QMutexLocker lock(&_tasksToProcessMutex);
 		for (auto &task : tasks) {
-			_tasksToProcess.push_back(std::move(task));
+			_tasksToProcess.push_back({ std::move(task), _tasksAdded++ });
 		}
 	}
 
@@ -255,40 +257,57 @@ void TaskQueue::addTasks(std::vector<std::unique_ptr<Task>> &&tasks) {
 }
 
 void TaskQueue::wakeThread() {
-	if (!_thread) {
-		_thread = new QThread();
-
-		_worker = new TaskQueueWorker(this);
-		_worker->moveToThread(_thread);
-
-		connect(this, SIGNAL(taskAdded()), _worker, SLOT(onTaskAdded()));
-		connect(_worker, SIGNAL(taskProcessed()), this, SLOT(onTaskProcessed()));
-
-		_thread->start();
+	if (_threads.empty()) {
+		for (auto i = 0; i != _threadsCount; ++i) {
+			const auto thread = new QThread();
+			const auto worker = new TaskQueueWorker(this);
+			worker->moveToThread(thread);
+
+			connect(this, SIGNAL(taskAdded()), worker, SLOT(onTaskAdded()));
+			connect(worker, SIGNAL(taskProcessed()), this, SLOT(onTaskProcessed()));
+
+			thread->start();
+			_threads.push_back(thread);
+			_workers.push_back(worker);
+		}
 	}
 	if (_stopTimer) _stopTimer->stop();
 	taskAdded();
 }
 
 void TaskQueue::cancelTask(TaskId id) {
-	const auto removeFrom = [&](std::deque<std::unique_ptr<Task>> &queue) {
-		const auto proj = [](const std::unique_ptr<Task> &task) {
-			return task->id();
-		};
-		auto i = ranges::find(queue, id, proj);
-		if (i != queue.end()) {
-			queue.erase(i);
-		}
-	};
+	auto skipped = false;
 	{
 		QMutexLocker lock(&_tasksToProcessMutex);
-		removeFrom(_tasksToProcess);
-		if (_taskInProcessId == id) {
-			_taskInProcessId = TaskId();
+		const auto proj = [](const Queued &queued) {
+			return queued.task->id();
+		};
+		const auto i = ranges::find(_tasksToProcess, id, proj);
+		if (i != end(_tasksToProcess)) {
+			// Leave a gap, so that the following tasks get finished.
+			const auto index = i->index;
+			_tasksToProcess.erase(i);
+
+			QMutexLocker lockToFinish(&_tasksToFinishMutex);
+			_tasksToFinish.emplace(index, nullptr);
+			skipped = true;
+		} else {
+			// The worker will leave the gap when it finishes processing.
+			_tasksInProcess.remove(id);
 		}
 	}
+	if (skipped) {
+		// Don't call other tasks finish() from inside cancelTask().
+		InvokeQueued(this, [=] { onTaskProcessed(); });
+		return;
+	}
 	QMutexLocker lock(&_tasksToFinishMutex);
-	removeFrom(_tasksToFinish);
+	for (auto &[index, task] : _tasksToFinish) {
+		if (task && task->id() == id) {
+			task = nullptr;
+			break;
+		}
+	}
 }
 
 void TaskQueue::onTaskProcessed() {
@@ -296,33 +315,50 @@ void TaskQueue::onTaskProcessed() {
 		auto task = std::unique_ptr<Task>();
 		{
 			QMutexLocker lock(&_tasksToFinishMutex);
-			if (_tasksToFinish.empty()) break;
-			task = std::move(_tasksToFinish.front());
-			_tasksToFinish.pop_front();
+			const auto i = _tasksToFinish.begin();
+			if (i == _tasksToFinish.end() || i->first != _tasksFinished) {
+				break;
+			}
+			task = std::move(i->second);
+			_tasksToFinish.erase(i);
+			++_tasksFinished;
+		}
+		if (task) {
+			task->finish();
 		}
-		task->finish();
 	} while (true);
 
 	if (_stopTimer) {
 		QMutexLocker lock(&_tasksToProcessMutex);
-		if (_tasksToProcess.empty() && !_taskInProcessId) {
+		if (_tasksToProcess.empty() && _tasksInProcess.empty()) {
 			_stopTimer->start();
 		}
 	}
 }
 
 void TaskQueue::stop() {
-	if (_thread) {
-		_thread->requestInterruption();
-		_thread->quit();
-		DEBUG_LOG(("Waiting for taskThread to finish"));
-		_thread->wait();
-		delete base::take(_worker);
-		delete base::take(_thread);
+	if (!_threads.empty()) {
+		for (const auto thread : _threads) {
+			thread->requestInterruption();
+			thread->quit();
+		}
+		DEBUG_LOG(("Waiting for %1 taskThreads to finish"
+			).arg(_threads.size()));
+		for (const auto thread : _threads) {
+			thread->wait();
+		}
+		for (const auto worker : base::take(_workers)) {
+			delete worker;
+		}
+		for (const auto thread : base::take(_threads)) {
+			delete thread;
+		}
 	}
 	_tasksToProcess.clear();
+	_tasksInProcess.clear();
+	_tasksAdded = 0;
 	_tasksToFinish.clear();
-	_taskInProcessId = TaskId();
+	_tasksFinished = 0;
 }
 
 TaskQueue::~TaskQueue() {
@@ -334,38 +370,35 @@ void TaskQueueWorker::onTaskAdded() {
 	if (_inTaskAdded) return;
 	_inTaskAdded = true;
 
-	bool someTasksLeft = false;
-	do {
+	while (!thread()->isInterruptionRequested()) {
 		auto task = std::unique_ptr<Task>();
+		auto index = uint64();
 		{
 			QMutexLocker lock(&_queue->_tasksToProcessMutex);
-			if (!_queue->_tasksToProcess.empty()) {
-				task = std::move(_queue->_tasksToProcess.front());
-				_queue->_tasksToProcess.pop_front();
-				_queue->_taskInProcessId = task->id();
+			if (_queue->_tasksToProcess.empty()) {
+				break;
 			}
+			auto &queued = _queue->_tasksToProcess.front();
+			task = std::move(queued.task);
+			index = queued.index;
+			_queue->_tasksToProcess.pop_front();
+			_queue->_tasksInProcess.emplace(task->id(), index);
 		}
 
-		if (task) {
-			task->process();
-			bool emitTaskProcessed = false;
-			{
-				QMutexLocker lockToProcess(&_queue->_tasksToProcessMutex);
-				if (_queue->_taskInProcessId == task->id()) {
-					_queue->_taskInProcessId = TaskId();
-					someTasksLeft = !_queue->_tasksToProcess.empty();
-
-					QMutexLocker lockToFinish(&_queue->_tasksToFinishMutex);
-					emitTaskProcessed = _queue->_tasksToFinish.empty();
-					_queue->_tasksToFinish.push_back(std::move(task));
-				}
-			}
-			if (emitTaskProcessed) {
-				taskProcessed();
+		task->process();
+		{
+			QMutexLocker lockToProcess(&_queue->_tasksToProcessMutex);
+			if (!_queue->_tasksInProcess.remove(task->id())) {
+				task = nullptr; // Cancelled while processing.
 			}
+
+			QMutexLocker lockToFinish(&_queue->_tasksToFinishMutex);
+			_queue->_tasksToFinish.emplace(index, std::move(task));
 		}
+		taskProcessed();
+
 		QCoreApplication::processEvents();
-	} while (someTasksLeft && !thread()->isInterruptionRequested());
+	}
 
 	_inTaskAdded = false;
 }
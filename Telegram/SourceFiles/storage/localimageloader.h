@@ -57,7 +57,12 @@ class TaskQueue : public QObject {
 	Q_OBJECT
 
 public:
-	explicit TaskQueue(crl::time stopTimeoutMs = 0); // <= 0 - never stop worker
+	// stopTimeoutMs <= 0 - never stop workers.
+	//
+	// With threads > 1 independent tasks are processed in parallel, while
+	// finish() is still called in the order the tasks were added, so that
+	// albums and groups of files are sent in the same order as chosen.
+	explicit TaskQueue(crl::time stopTimeoutMs = 0, int threads = 1);
 
 	TaskId addTask(std::unique_ptr<Task> &&task);
 	void addTasks(std::vector<std::unique_ptr<Task>> &&tasks);
@@ -75,14 +80,26 @@ public Q_SLOTS:
 private:
 	friend class TaskQueueWorker;
 
+	struct Queued {
+		std::unique_ptr<Task> task;
+		uint64 index = 0;
+	};
+
 	void wakeThread();
 
-	std::deque<std::unique_ptr<Task>> _tasksToProcess;
-	std::deque<std::unique_ptr<Task>> _tasksToFinish;
-	TaskId _taskInProcessId = TaskId();
+	// Both guarded by _tasksToProcessMutex.
+	std::deque<Queued> _tasksToProcess;
+	base::flat_map<TaskId, uint64> _tasksInProcess;
+	uint64 _tasksAdded = 0;
+
+	// Guarded by _tasksToFinishMutex, cancelled tasks leave nullptr-s.
+	base::flat_map<uint64, std::unique_ptr<Task>> _tasksToFinish;
+	uint64 _tasksFinished = 0;
+
 	QMutex _tasksToProcessMutex, _tasksToFinishMutex;
-	QThread *_thread = nullptr;
-	TaskQueueWorker *_worker = nullptr;
+	const int _threadsCount = 1;
+	std::vector<QThread*> _threads;
+	std::vector<TaskQueueWorker*> _workers;
 	QTimer *_stopTimer = nullptr;
 
 };
@@ -39,6 +39,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "webview/webview_interface.h"
 #include "window/themes/window_theme.h"
 
+#include <xxhash.h> // XXH64.
+
 namespace Storage {
 namespace {
 
@@ -50,7 +52,8 @@ constexpr auto kWriteSearchSuggestionsDelay = 5 * crl::time(1000);
 constexpr auto kMaxSavedPlaybackPositions = 256;
 
 constexpr auto kStickersVersionTag = quint32(-1);
-constexpr auto kStickersSerializeVersion = 4;
+constexpr auto kStickersSerializeVersion = 5;
+constexpr auto kStickersSeparateRecordsVersion = 5;
 constexpr auto kMaxSavedStickerSetsCount = 1000;
 constexpr auto kDefaultStickerInstallDate = TimeId(1);
 
@@ -287,6 +290,11 @@ base::flat_set<QString> Account::collectGoodNames() const {
 	for (const auto &[key, value] : _botStoragesMap) {
 		push(value);
 	}
+	for (const auto &[key, records] : _stickerSetRecords) {
+		for (const auto &[id, record] : records) {
+			push(record.key);
+		}
+	}
 	for (const auto &value : keys) {
 		push(value);
 	}
@@ -543,6 +551,7 @@ Account::ReadMapResult Account::readMapWith(
 	if (_locationsKey) {
 		readLocations();
 	}
+	readAllStickerSetRecords();
 	if (_legacyBackgroundKeyDay || _legacyBackgroundKeyNight) {
 		Local::moveLegacyBackground(
 			_basePath,
@@ -770,6 +779,7 @@ void Account::reset() {
 	_roundPlaceholderKey = 0;
 	_inlineBotsDownloadsKey = 0;
 	_mediaLastPlaybackPositionsKey = 0;
+	_stickerSetRecords.clear();
 	_oldMapVersion = 0;
 	_fileLocations.clear();
 	_fileLocationPairs.clear();
@@ -1862,6 +1872,20 @@ Cache::Database::Settings Account::cacheBigFileSettings() const {
 	return result;
 }
 
+QString Account::messagesPath() const {
+	Expects(!_databasePath.isEmpty());
+
+	return _databasePath + "messages";
+}
+
+Cache::Database::Settings Account::messagesSettings() const {
+	auto result = Cache::Database::Settings();
+	result.clearOnWrongKey = true;
+	result.totalSizeLimit = _cacheTotalSizeLimit;
+	result.totalTimeLimit = _cacheTotalTimeLimit;
+	return result;
+}
+
 void Account::writeStickerSet(
 		QDataStream &stream,
 		const Data::StickersSet &set) {
@@ -1916,107 +1940,379 @@ enum class StickerSetCheckResult {
 };
 
 // CheckSet is a functor on Data::StickersSet, which returns a StickerSetCheckResult.
+//
+// Each set is kept in a separate record file, the stickersKey file holds
+// only the record keys with content checksums and the sets order.
+// This way only the sets that were changed since last time are written.
 template <typename CheckSet>
 void Account::writeStickerSets(
 		FileKey &stickersKey,
 		CheckSet checkSet,
 		const Data::StickersSetsOrder &order) {
-	using SetFlag = Data::StickersSetFlag;
-
-	const auto &sets = _owner->session().data().stickers().sets();
-	if (sets.empty()) {
+	const auto clear = [&] {
 		if (stickersKey) {
+			clearStickerSetRecords(stickersKey);
 			ClearKey(stickersKey, _basePath);
 			stickersKey = 0;
 			writeMapDelayed();
 		}
-		return;
+	};
+	const auto &sets = _owner->session().data().stickers().sets();
+	if (sets.empty()) {
+		return clear();
 	}
 
-	// versionTag + version + count
-	quint32 size = sizeof(quint32) + sizeof(qint32) + sizeof(qint32);
-
-	int32 setsCount = 0;
+	auto serialized = std::vector<std::pair<uint64, QByteArray>>();
+	serialized.reserve(sets.size());
 	for (const auto &[id, set] : sets) {
-		const auto raw = set.get();
-		auto result = checkSet(*raw);
+		const auto result = checkSet(*set);
 		if (result == StickerSetCheckResult::Abort) {
 			return;
 		} else if (result == StickerSetCheckResult::Skip) {
 			continue;
 		}
-
-		// id
-		// + accessHash
-		// + hash
-		// + title
-		// + shortName
-		// + stickersCount
-		// + flags
-		// + installDate
-		// + thumbnailDocumentId
-		// + thumbnailType
-		// + thumbnailLocation
-		size += sizeof(quint64) * 3
-			+ Serialize::stringSize(raw->title)
-			+ Serialize::stringSize(raw->shortName)
-			+ sizeof(qint32) * 3
-			+ sizeof(quint64)
-			+ sizeof(qint32)
-			+ Serialize::imageLocationSize(raw->thumbnailLocation());
-		if (raw->flags & SetFlag::NotLoaded) {
-			continue;
-		}
-
-		for (const auto sticker : std::as_const(raw->stickers)) {
-			size += Serialize::Document::sizeInStream(sticker);
-		}
-
-		size += sizeof(qint32); // datesCount
-		if (!raw->dates.empty()) {
-			Assert(raw->stickers.size() == raw->dates.size());
-			size += raw->dates.size() * sizeof(qint32);
+		auto bytes = QByteArray();
+		{
+			auto stream = QDataStream(&bytes, QIODevice::WriteOnly);
+			stream.setVersion(QDataStream::Qt_5_1);
+			writeStickerSet(stream, *set);
 		}
-
-		size += sizeof(qint32); // emojiCount
-		for (auto j = raw->emoji.cbegin(), e = raw->emoji.cend(); j != e; ++j) {
-			size += Serialize::stringSize(j->first->id()) + sizeof(qint32) + (j->second.size() * sizeof(quint64));
+		if (!bytes.isEmpty()) {
+			serialized.emplace_back(id, std::move(bytes));
 		}
-
-		++setsCount;
 	}
-	if (!setsCount && order.isEmpty()) {
-		if (stickersKey) {
-			ClearKey(stickersKey, _basePath);
-			stickersKey = 0;
-			writeMapDelayed();
-		}
-		return;
+	if (serialized.empty() && order.isEmpty()) {
+		return clear();
 	}
-	size += sizeof(qint32) + (order.size() * sizeof(quint64));
 
 	if (!stickersKey) {
 		stickersKey = GenerateKey(_basePath);
 		writeMapQueued();
 	}
+	auto &records = _stickerSetRecords[stickersKey];
+	auto updated = base::flat_map<uint64, StickerSetRecord>();
+	updated.reserve(serialized.size());
+	for (const auto &[id, bytes] : serialized) {
+		auto record = StickerSetRecord();
+		if (const auto i = records.find(id); i != end(records)) {
+			record = i->second;
+			records.erase(i);
+		}
+		const auto checksum = uint64(XXH64(bytes.constData(), bytes.size(), 0));
+		if (!record.key || record.checksum != checksum) {
+			if (!record.key) {
+				record.key = GenerateKey(_basePath);
+			}
+			record.checksum = checksum;
+
+			// versionTag + version + set
+			EncryptedDescriptor data(
+				sizeof(quint32) + sizeof(qint32) + bytes.size());
+			data.stream
+				<< quint32(kStickersVersionTag)
+				<< qint32(kStickersSerializeVersion);
+			data.stream.writeRawData(bytes.constData(), bytes.size());
+
+			FileWriteDescriptor file(record.key, _basePath);
+			file.writeEncrypted(data, _localKey);
+		}
+		updated.emplace(id, record);
+	}
+	const auto stale = std::exchange(records, std::move(updated));
+
+	// versionTag + version + count
+	// + (id + key + checksum) * count
+	// + order
+	const auto size = sizeof(quint32) + sizeof(qint32) + sizeof(qint32)
+		+ records.size() * sizeof(quint64) * 3
+		+ sizeof(qint32) + (order.size() * sizeof(quint64));
 	EncryptedDescriptor data(size);
 	data.stream
 		<< quint32(kStickersVersionTag)
 		<< qint32(kStickersSerializeVersion)
-		<< qint32(setsCount);
-	for (const auto &[id, set] : sets) {
-		auto result = checkSet(*set);
-		if (result == StickerSetCheckResult::Abort) {
+		<< qint32(records.size());
+	for (const auto &[id, record] : records) {
+		data.stream
+			<< quint64(id)
+			<< quint64(record.key)
+			<< quint64(record.checksum);
+	}
+	data.stream << order;
+
+	{
+		FileWriteDescriptor file(stickersKey, _basePath);
+		file.writeEncrypted(data, _localKey);
+	}
+
+	// Remove records only after the list stopped referencing them,
+	// so that an interrupted write leaves a readable list on disk.
+	for (const auto &[id, record] : stale) {
+		ClearKey(record.key, _basePath);
+	}
+}
+
+void Account::clearStickerSetRecords(FileKey stickersKey) {
+	const auto i = _stickerSetRecords.find(stickersKey);
+	if (i == end(_stickerSetRecords)) {
+		return;
+	}
+	for (const auto &[id, record] : i->second) {
+		ClearKey(record.key, _basePath);
+	}
+	_stickerSetRecords.erase(i);
+}
+
+void Account::readAllStickerSetRecords() {
+	const auto keys = {
+		_installedStickersKey,
+		_featuredStickersKey,
+		_recentStickersKey,
+		_favedStickersKey,
+		_archivedStickersKey,
+		_installedMasksKey,
+		_recentMasksKey,
+		_archivedMasksKey,
+		_installedCustomEmojiKey,
+		_featuredCustomEmojiKey,
+		_archivedCustomEmojiKey,
+	};
+	for (const auto stickersKey : keys) {
+		if (stickersKey) {
+			readStickerSetRecords(stickersKey);
+		}
+	}
+}
+
+// Only the (set id, record key, checksum) table is read here, so that
+// legacy files cleanup keeps the records of lists that are read lazily.
+void Account::readStickerSetRecords(FileKey stickersKey) {
+	FileReadDescriptor stickers;
+	if (!ReadEncryptedFile(stickers, stickersKey, _basePath, _localKey)) {
+		return;
+	}
+	quint32 versionTag = 0;
+	qint32 version = 0;
+	qint32 count = 0;
+	stickers.stream >> versionTag >> version >> count;
+	if (!CheckStreamStatus(stickers.stream)
+		|| (versionTag != kStickersVersionTag)
+		|| (version < kStickersSeparateRecordsVersion)
+		|| (count < 0)
+		|| (count > kMaxSavedStickerSetsCount)) {
+		return;
+	}
+	auto records = base::flat_map<uint64, StickerSetRecord>();
+	records.reserve(count);
+	for (auto i = 0; i != count; ++i) {
+		auto setId = quint64();
+		auto record = StickerSetRecord();
+		stickers.stream >> setId >> record.key >> record.checksum;
+		if (!CheckStreamStatus(stickers.stream)) {
 			return;
-		} else if (result == StickerSetCheckResult::Skip) {
+		}
+		records.emplace(setId, record);
+	}
+	_stickerSetRecords[stickersKey] = std::move(records);
+}
+
+bool Account::readStickerSet(
+		details::FileReadDescriptor &stickers,
+		qint32 version) {
+	using SetFlag = Data::StickersSetFlag;
+
+	auto &sets = _owner->session().data().stickers().setsRef();
+	quint64 setId = 0, setAccessHash = 0, setHash = 0;
+	quint64 setThumbnailDocumentId = 0;
+	QString setTitle, setShortName;
+	qint32 scnt = 0;
+	qint32 setInstallDate = 0;
+	Data::StickersSetFlags setFlags = 0;
+	qint32 setFlagsValue = 0;
+	qint32 setThumbnailType = qint32(StickerType::Webp);
+	ImageLocation setThumbnail;
+
+	stickers.stream
+		>> setId
+		>> setAccessHash
+		>> setHash
+		>> setTitle
+		>> setShortName
+		>> scnt
+		>> setFlagsValue
+		>> setInstallDate;
+	if (version > 2) {
+		stickers.stream >> setThumbnailDocumentId;
+		if (version > 3) {
+			stickers.stream >> setThumbnailType;
+		}
+	}
+
+	constexpr auto kLegacyFlagWebm = (1 << 8);
+	if ((version < 4) && (setFlagsValue & kLegacyFlagWebm)) {
+		setThumbnailType = qint32(StickerType::Webm);
+	}
+	const auto thumbnail = Serialize::readImageLocation(
+		stickers.version,
+		stickers.stream);
+	if (!thumbnail || !CheckStreamStatus(stickers.stream)) {
+		return false;
+	} else if (thumbnail->valid() && thumbnail->isLegacy()) {
+		// No thumb_version information in legacy location.
+		return false;
+	} else {
+		setThumbnail = *thumbnail;
+	}
+
+	setFlags = Data::StickersSetFlags::from_raw(setFlagsValue);
+	if (setId == Data::Stickers::DefaultSetId) {
+		setTitle = tr::lng_stickers_default_set(tr::now);
+		setFlags |= SetFlag::Official | SetFlag::Special;
+	} else if (setId == Data::Stickers::CustomSetId) {
+		setTitle = u"Custom stickers"_q;
+		setFlags |= SetFlag::Special;
+	} else if ((setId == Data::Stickers::CloudRecentSetId)
+			|| (setId == Data::Stickers::CloudRecentAttachedSetId)) {
+		setTitle = tr::lng_recent_stickers(tr::now);
+		setFlags |= SetFlag::Special;
+	} else if (setId == Data::Stickers::FavedSetId) {
+		setTitle = Lang::Hard::FavedSetTitle();
+		setFlags |= SetFlag::Special;
+	} else if (!setId) {
+		return true;
+	}
+
+	auto it = sets.find(setId);
+	auto settingSet = (it == sets.cend());
+	if (settingSet) {
+		// We will set this flags from order lists when reading those stickers.
+		setFlags &= ~(SetFlag::Installed | SetFlag::Featured);
+		it = sets.emplace(setId, std::make_unique<Data::StickersSet>(
+			&_owner->session().data(),
+			setId,
+			setAccessHash,
+			setHash,
+			setTitle,
+			setShortName,
+			0,
+			setFlags,
+			setInstallDate)).first;
+		it->second->thumbnailDocumentId = setThumbnailDocumentId;
+	}
+	const auto set = it->second.get();
+	const auto inputSet = set->identifier();
+	const auto fillStickers = set->stickers.isEmpty();
+
+	if (scnt < 0) { // disabled not loaded set
+		if (!set->count || fillStickers) {
+			set->count = -scnt;
+		}
+		return true;
+	}
+
+	if (fillStickers) {
+		set->stickers.reserve(scnt);
+		set->count = 0;
+	}
+
+	Serialize::Document::StickerSetInfo info(
+		setId,
+		setAccessHash,
+		setShortName);
+	base::flat_set<DocumentId> read;
+	for (int32 j = 0; j < scnt; ++j) {
+		auto document = Serialize::Document::readStickerFromStream(
+			&_owner->session(),
+			stickers.version,
+			stickers.stream, info);
+		if (!CheckStreamStatus(stickers.stream)) {
+			return false;
+		} else if (!document
+			|| !document->sticker()
+			|| read.contains(document->id)) {
 			continue;
 		}
-		writeStickerSet(data.stream, *set);
+		read.emplace(document->id);
+		if (fillStickers) {
+			set->stickers.push_back(document);
+			if (!(set->flags & SetFlag::Special)) {
+				if (!document->sticker()->set.id) {
+					document->sticker()->set = inputSet;
+				}
+			}
+			++set->count;
+		}
 	}
-	data.stream << order;
 
-	FileWriteDescriptor file(stickersKey, _basePath);
-	file.writeEncrypted(data, _localKey);
+	qint32 datesCount = 0;
+	stickers.stream >> datesCount;
+	if (datesCount > 0) {
+		if (datesCount != scnt) {
+			return false;
+		}
+		const auto fillDates
+			= ((set->id == Data::Stickers::CloudRecentSetId)
+				|| (set->id == Data::Stickers::CloudRecentAttachedSetId))
+			&& (set->stickers.size() == datesCount);
+		if (fillDates) {
+			set->dates.clear();
+			set->dates.reserve(datesCount);
+		}
+		for (auto i = 0; i != datesCount; ++i) {
+			qint32 date = 0;
+			stickers.stream >> date;
+			if (fillDates) {
+				set->dates.push_back(TimeId(date));
+			}
+		}
+	}
+
+	qint32 emojiCount = 0;
+	stickers.stream >> emojiCount;
+	if (!CheckStreamStatus(stickers.stream) || emojiCount < 0) {
+		return false;
+	}
+	for (int32 j = 0; j < emojiCount; ++j) {
+		QString emojiString;
+		qint32 stickersCount;
+		stickers.stream >> emojiString >> stickersCount;
+		Data::StickersPack pack;
+		pack.reserve(stickersCount);
+		for (int32 k = 0; k < stickersCount; ++k) {
+			quint64 id;
+			stickers.stream >> id;
+			const auto doc = _owner->session().data().document(id);
+			if (!doc->sticker()) continue;
+
+			pack.push_back(doc);
+		}
+		if (fillStickers) {
+			if (auto emoji = Ui::Emoji::Find(emojiString)) {
+				emoji = emoji->original();
+				set->emoji[emoji] = std::move(pack);
+			}
+		}
+	}
+
+	if (settingSet) {
+		if (version < 4
+			&& setThumbnailType == qint32(StickerType::Webp)
+			&& !set->stickers.empty()
+			&& set->stickers.front()->sticker()) {
+			const auto first = set->stickers.front();
+			setThumbnailType = qint32(first->sticker()->type);
+		}
+		const auto thumbType = [&] {
+			switch (setThumbnailType) {
+			case qint32(StickerType::Webp): return StickerType::Webp;
+			case qint32(StickerType::Tgs): return StickerType::Tgs;
+			case qint32(StickerType::Webm): return StickerType::Webm;
+			}
+			return StickerType::Webp;
+		}();
+		set->setThumbnail(
+			ImageWithLocation{ .location = setThumbnail }, thumbType);
+	}
+	return true;
 }
 
 void Account::readStickerSets(
@@ -2034,6 +2330,7 @@ void Account::readStickerSets(
 	}
 
 	const auto failed = [&] {
+		clearStickerSetRecords(stickersKey);
 		ClearKey(stickersKey, _basePath);
 		stickersKey = 0;
 	};
@@ -2055,197 +2352,37 @@ void Account::readStickerSets(
 		|| (count > kMaxSavedStickerSetsCount)) {
 		return failed();
 	}
-	for (auto i = 0; i != count; ++i) {
-		quint64 setId = 0, setAccessHash = 0, setHash = 0;
-		quint64 setThumbnailDocumentId = 0;
-		QString setTitle, setShortName;
-		qint32 scnt = 0;
-		qint32 setInstallDate = 0;
-		Data::StickersSetFlags setFlags = 0;
-		qint32 setFlagsValue = 0;
-		qint32 setThumbnailType = qint32(StickerType::Webp);
-		ImageLocation setThumbnail;
-
-		stickers.stream
-			>> setId
-			>> setAccessHash
-			>> setHash
-			>> setTitle
-			>> setShortName
-			>> scnt
-			>> setFlagsValue
-			>> setInstallDate;
-		if (version > 2) {
-			stickers.stream >> setThumbnailDocumentId;
-			if (version > 3) {
-				stickers.stream >> setThumbnailType;
-			}
-		}
-
-		constexpr auto kLegacyFlagWebm = (1 << 8);
-		if ((version < 4) && (setFlagsValue & kLegacyFlagWebm)) {
-			setThumbnailType = qint32(StickerType::Webm);
-		}
-		const auto thumbnail = Serialize::readImageLocation(
-			stickers.version,
-			stickers.stream);
-		if (!thumbnail || !CheckStreamStatus(stickers.stream)) {
-			return failed();
-		} else if (thumbnail->valid() && thumbnail->isLegacy()) {
-			// No thumb_version information in legacy location.
-			return failed();
-		} else {
-			setThumbnail = *thumbnail;
-		}
-
-		setFlags = Data::StickersSetFlags::from_raw(setFlagsValue);
-		if (setId == Data::Stickers::DefaultSetId) {
-			setTitle = tr::lng_stickers_default_set(tr::now);
-			setFlags |= SetFlag::Official | SetFlag::Special;
-		} else if (setId == Data::Stickers::CustomSetId) {
-			setTitle = u"Custom stickers"_q;
-			setFlags |= SetFlag::Special;
-		} else if ((setId == Data::Stickers::CloudRecentSetId)
-				|| (setId == Data::Stickers::CloudRecentAttachedSetId)) {
-			setTitle = tr::lng_recent_stickers(tr::now);
-			setFlags |= SetFlag::Special;
-		} else if (setId == Data::Stickers::FavedSetId) {
-			setTitle = Lang::Hard::FavedSetTitle();
-			setFlags |= SetFlag::Special;
-		} else if (!setId) {
-			continue;
-		}
-
-		auto it = sets.find(setId);
-		auto settingSet = (it == sets.cend());
-		if (settingSet) {
-			// We will set this flags from order lists when reading those stickers.
-			setFlags &= ~(SetFlag::Installed | SetFlag::Featured);
-			it = sets.emplace(setId, std::make_unique<Data::StickersSet>(
-				&_owner->session().data(),
-				setId,
-				setAccessHash,
-				setHash,
-				setTitle,
-				setShortName,
-				0,
-				setFlags,
-				setInstallDate)).first;
-			it->second->thumbnailDocumentId = setThumbnailDocumentId;
-		}
-		const auto set = it->second.get();
-		const auto inputSet = set->identifier();
-		const auto fillStickers = set->stickers.isEmpty();
-
-		if (scnt < 0) { // disabled not loaded set
-			if (!set->count || fillStickers) {
-				set->count = -scnt;
+	if (version < kStickersSeparateRecordsVersion) {
+		for (auto i = 0; i != count; ++i) {
+			if (!readStickerSet(stickers, version)) {
+				return failed();
 			}
-			continue;
 		}
-
-		if (fillStickers) {
-			set->stickers.reserve(scnt);
-			set->count = 0;
-		}
-
-		Serialize::Document::StickerSetInfo info(
-			setId,
-			setAccessHash,
-			setShortName);
-		base::flat_set<DocumentId> read;
-		for (int32 j = 0; j < scnt; ++j) {
-			auto document = Serialize::Document::readStickerFromStream(
-				&_owner->session(),
-				stickers.version,
-				stickers.stream, info);
+	} else {
+		auto &records = _stickerSetRecords[stickersKey];
+		records.clear();
+		for (auto i = 0; i != count; ++i) {
+			auto setId = quint64();
+			auto record = StickerSetRecord();
+			stickers.stream >> setId >> record.key >> record.checksum;
 			if (!CheckStreamStatus(stickers.stream)) {
 				return failed();
-			} else if (!document
-				|| !document->sticker()
-				|| read.contains(document->id)) {
-				continue;
-			}
-			read.emplace(document->id);
-			if (fillStickers) {
-				set->stickers.push_back(document);
-				if (!(set->flags & SetFlag::Special)) {
-					if (!document->sticker()->set.id) {
-						document->sticker()->set = inputSet;
-					}
-				}
-				++set->count;
 			}
+			records.emplace(setId, record);
 		}
-
-		qint32 datesCount = 0;
-		stickers.stream >> datesCount;
-		if (datesCount > 0) {
-			if (datesCount != scnt) {
+		for (const auto &[setId, record] : records) {
+			FileReadDescriptor set;
+			if (!ReadEncryptedFile(set, record.key, _basePath, _localKey)) {
 				return failed();
 			}
-			const auto fillDates
-				= ((set->id == Data::Stickers::CloudRecentSetId)
-					|| (set->id == Data::Stickers::CloudRecentAttachedSetId))
-				&& (set->stickers.size() == datesCount);
-			if (fillDates) {
-				set->dates.clear();
-				set->dates.reserve(datesCount);
-			}
-			for (auto i = 0; i != datesCount; ++i) {
-				qint32 date = 0;
-				stickers.stream >> date;
-				if (fillDates) {
-					set->dates.push_back(TimeId(date));
-				}
-			}
-		}
-
-		qint32 emojiCount = 0;
-		stickers.stream >> emojiCount;
-		if (!CheckStreamStatus(stickers.stream) || emojiCount < 0) {
-			return failed();
-		}
-		for (int32 j = 0; j < emojiCount; ++j) {
-			QString emojiString;
-			qint32 stickersCount;
-			stickers.stream >> emojiString >> stickersCount;
-			Data::StickersPack pack;
-			pack.reserve(stickersCount);
-			for (int32 k = 0; k < stickersCount; ++k) {
-				quint64 id;
-				stickers.stream >> id;
-				const auto doc = _owner->session().data().document(id);
-				if (!doc->sticker()) continue;
-
-				pack.push_back(doc);
-			}
-			if (fillStickers) {
-				if (auto emoji = Ui::Emoji::Find(emojiString)) {
-					emoji = emoji->original();
-					set->emoji[emoji] = std::move(pack);
-				}
-			}
-		}
-
-		if (settingSet) {
-			if (version < 4
-				&& setThumbnailType == qint32(StickerType::Webp)
-				&& !set->stickers.empty()
-				&& set->stickers.front()->sticker()) {
-				const auto first = set->stickers.front();
-				setThumbnailType = qint32(first->sticker()->type);
+			auto setVersionTag = quint32();
+			auto setVersion = qint32();
+			set.stream >> setVersionTag >> setVersion;
+			if (setVersionTag != kStickersVersionTag
+				|| setVersion < kStickersSeparateRecordsVersion
+				|| !readStickerSet(set, setVersion)) {
+				return failed();
 			}
-			const auto thumbType = [&] {
-				switch (setThumbnailType) {
-				case qint32(StickerType::Webp): return StickerType::Webp;
-				case qint32(StickerType::Tgs): return StickerType::Tgs;
-				case qint32(StickerType::Webm): return StickerType::Webm;
-				}
-				return StickerType::Webp;
-			}();
-			set->setThumbnail(
-				ImageWithLocation{ .location = setThumbnail }, thumbType);
 		}
 	}
 
@@ -120,6 +120,9 @@ public:
 	[[nodiscard]] QString cacheBigFilePath() const;
 	[[nodiscard]] Cache::Database::Settings cacheBigFileSettings() const;
 
+	[[nodiscard]] QString messagesPath() const;
+	[[nodiscard]] Cache::Database::Settings messagesSettings() const;
+
 	void writeInstalledStickers();
 	void writeFeaturedStickers();
 	void writeRecentStickers();
@@ -266,6 +269,12 @@ private:
 		FileKey &stickersKey,
 		CheckSet checkSet,
 		const Data::StickersSetsOrder &order);
+	void clearStickerSetRecords(FileKey stickersKey);
+	void readAllStickerSetRecords();
+	void readStickerSetRecords(FileKey stickersKey);
+	[[nodiscard]] bool readStickerSet(
+		details::FileReadDescriptor &stickers,
+		qint32 version);
 	void readStickerSets(
 		FileKey &stickersKey,
 		Data::StickersSetsOrder *outOrder = nullptr,
@@ -337,6 +346,15 @@ private:
 	qint32 _cacheTotalTimeLimit = 0;
 	qint32 _cacheBigFileTotalTimeLimit = 0;
 
+	// Set records by set id, for each of the sticker sets list keys.
+	struct StickerSetRecord {
+		FileKey key = 0;
+		quint64 checksum = 0;
+	};
+	base::flat_map<
+		FileKey,
+		base::flat_map<uint64, StickerSetRecord>> _stickerSetRecords;
+
 	base::flat_map<PeerId, base::flags<PeerTrustFlag>> _trustedPeers;
 	base::flat_map<PeerId, int> _trustedPayPerMessage;
 	bool _trustedPeersRead = false;
@@ -0,0 +1,295 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "storage/storage_messages_database.h"
+
+#include "base/options.h"
+#include "core/application.h"
+#include "main/main_session.h"
+#include "storage/storage_account.h"
+
+namespace Storage {
+namespace {
+
+constexpr auto kIndexVersion = quint32(1);
+constexpr auto kMaxStoredMessages = 100;
+
+base::options::toggle LocalMessagesDatabaseOption({
+	.id = kOptionLocalMessagesDatabase,
+	.name = "Local messages database",
+	.description = "Keep an encrypted copy of recent messages on disk "
+		"to show chats before they are loaded from the server.",
+	.restartRequired = true,
+});
+
+struct Index {
+	std::vector<MsgId> ids;
+	QByteArray users;
+	QByteArray chats;
+};
+
+[[nodiscard]] Cache::Key IndexKey(PeerId peer) {
+	return { peer.value, 0ULL };
+}
+
+[[nodiscard]] Cache::Key MessageKey(PeerId peer, MsgId id) {
+	return { peer.value, uint64(id.bare) };
+}
+
+template <typename Type>
+[[nodiscard]] QByteArray SerializeTL(const Type &value) {
+	auto buffer = mtpBuffer();
+	value.write(buffer);
+	return QByteArray(
+		reinterpret_cast<const char*>(buffer.constData()),
+		buffer.size() * sizeof(mtpPrime));
+}
+
+template <typename Type>
+[[nodiscard]] std::optional<Type> DeserializeTL(const QByteArray &bytes) {
+	if (bytes.isEmpty() || (bytes.size() % sizeof(mtpPrime))) {
+		return std::nullopt;
+	}
+	auto buffer = mtpBuffer(bytes.size() / sizeof(mtpPrime));
+	bytes::copy(bytes::make_span(buffer), bytes::make_span(bytes));
+	auto from = buffer.constData();
+	const auto end = from + buffer.size();
+	auto result = Type();
+	if (!result.read(from, end) || from != end) {
+		return std::nullopt;
+	}
+	return result;
+}
+
+[[nodiscard]] bool HasTimeToLive(const MTPMessage &message) {
+	return message.match([](const MTPDmessageEmpty &) {
+		return false;
+	}, [](const MTPDmessageService &data) {
+		return data.vttl_period().has_value();
+	}, [](const MTPDmessage &data) {
+		if (data.vttl_period()) {
+			return true;
+		} else if (const auto media = data.vmedia()) {
+			return media->match([](const MTPDmessageMediaPhoto &data) {
+				return data.vttl_seconds().has_value();
+			}, [](const MTPDmessageMediaDocument &data) {
+				return data.vttl_seconds().has_value();
+			}, [](const auto &) {
+				return false;
+			});
+		}
+		return false;
+	});
+}
+
+[[nodiscard]] QByteArray SerializeIndex(const Index &index) {
+	auto result = QByteArray();
+	{
+		auto stream = QDataStream(&result, QIODevice::WriteOnly);
+		stream.setVersion(QDataStream::Qt_5_1);
+		stream << kIndexVersion << qint32(index.ids.size());
+		for (const auto id : index.ids) {
+			stream << qint64(id.bare);
+		}
+		stream << index.users << index.chats;
+	}
+	return result;
+}
+
+[[nodiscard]] std::optional<Index> DeserializeIndex(
+		const QByteArray &bytes) {
+	auto stream = QDataStream(bytes);
+	stream.setVersion(QDataStream::Qt_5_1);
+	auto version = quint32();
+	auto count = qint32();
+	stream >> version >> count;
+	if (stream.status() != QDataStream::Ok
+		|| version != kIndexVersion
+		|| count < 0
+		|| count > kMaxStoredMessages) {
+		return std::nullopt;
+	}
+	auto result = Index();
+	result.ids.reserve(count);
+	for (auto i = 0; i != count; ++i) {
+		auto id = qint64();
+		stream >> id;
+		result.ids.push_back(MsgId(id));
+	}
+	stream >> result.users >> result.chats;
+	if (stream.status() != QDataStream::Ok) {
+		return std::nullopt;
+	}
+	return result;
+}
+
+} // namespace
+
+struct MessagesDatabase::Write {
+	std::optional<Index> index; // std::nullopt removes the whole history.
+	std::vector<QByteArray> messages;
+};
+
+const char kOptionLocalMessagesDatabase[] = "local-messages-database";
+
+MessagesDatabase::MessagesDatabase(not_null<Main::Session*> session)
+: _session(session)
+, _database(Core::App().databases().get(
+	_session->local().messagesPath(),
+	_session->local().messagesSettings())) {
+	_database->open(_session->local().cacheKey());
+}
+
+MessagesDatabase::~MessagesDatabase() = default;
+
+bool MessagesDatabase::Enabled() {
+	return LocalMessagesDatabaseOption.value();
+}
+
+void MessagesDatabase::putBottomSlice(
+		PeerId peer,
+		const MTPmessages_Messages &result) {
+	auto index = Index();
+	auto messages = QVector<MTPMessage>();
+	result.match([](const MTPDmessages_messagesNotModified &) {
+	}, [&](const auto &data) {
+		messages = data.vmessages().v;
+		index.users = SerializeTL(data.vusers());
+		index.chats = SerializeTL(data.vchats());
+	});
+	if (messages.isEmpty()) {
+		return;
+	} else if (messages.size() > kMaxStoredMessages) {
+		messages.resize(kMaxStoredMessages);
+	}
+	auto write = std::make_unique<Write>();
+	index.ids.reserve(messages.size());
+	write->messages.reserve(messages.size());
+	for (const auto &message : messages) {
+		const auto id = IdFromMessage(message);
+
+		// Self-destructing messages never go to disk.
+		if (!IsServerMsgId(id) || HasTimeToLive(message)) {
+			continue;
+		}
+		index.ids.push_back(id);
+		write->messages.push_back(SerializeTL(message));
+	}
+	write->index = std::move(index);
+	this->write(peer, std::move(write));
+}
+
+void MessagesDatabase::getBottomSlice(
+		PeerId peer,
+		Fn<void(MessagesDatabaseSlice&&)> done) {
+	struct State {
+		MessagesDatabaseSlice slice;
+		std::vector<std::optional<MTPMessage>> messages;
+		int waiting = 0;
+	};
+	const auto database = _database.get();
+	const auto weak = base::make_weak(this);
+	const auto finish = [=](const std::shared_ptr<State> &state) {
+		for (auto &message : state->messages) {
+			if (message) {
+				state->slice.messages.push_back(std::move(*message));
+			}
+		}
+		crl::on_main(weak, [=] {
+			done(std::move(state->slice));
+		});
+	};
+	database->get(IndexKey(peer), [=](QByteArray &&value) {
+		const auto index = DeserializeIndex(value);
+		const auto state = std::make_shared<State>();
+		if (!index || index->ids.empty()) {
+			finish(state);
+			return;
+		}
+		const auto users = DeserializeTL<MTPVector<MTPUser>>(index->users);
+		const auto chats = DeserializeTL<MTPVector<MTPChat>>(index->chats);
+		if (users) {
+			state->slice.users = users->v;
+		}
+		if (chats) {
+			state->slice.chats = chats->v;
+		}
+		state->messages.resize(index->ids.size());
+		state->waiting = int(index->ids.size());
+
+		// All callbacks are invoked on the database queue one by one.
+		for (auto i = 0; i != int(index->ids.size()); ++i) {
+			const auto key = MessageKey(peer, index->ids[i]);
+			database->get(key, [=](QByteArray &&value) {
+				state->messages[i] = DeserializeTL<MTPMessage>(value);
+				if (!--state->waiting) {
+					finish(state);
+				}
+			});
+		}
+	});
+}
+
+void MessagesDatabase::removeHistory(PeerId peer) {
+	write(peer, std::make_unique<Write>());
+}
+
+void MessagesDatabase::write(PeerId peer, std::unique_ptr<Write> write) {
+	if (_writing.contains(peer)) {
+		// Only the latest state of the history matters.
+		_pendingWrites[peer] = std::move(write);
+		return;
+	}
+	_writing.emplace(peer);
+	const auto database = _database.get();
+	const auto weak = base::make_weak(this);
+	const auto shared = std::shared_ptr<Write>(std::move(write));
+	database->get(IndexKey(peer), [=](QByteArray &&value) {
+		// We're on the database queue and no other write of this history
+		// is in flight, so the index we got is the one being replaced.
+		const auto was = DeserializeIndex(value);
+		const auto &now = shared->index;
+		if (was) {
+			for (const auto id : was->ids) {
+				if (!now || !ranges::contains(now->ids, id)) {
+					database->remove(MessageKey(peer, id));
+				}
+			}
+		}
+		if (now) {
+			for (auto i = 0; i != int(now->ids.size()); ++i) {
+				database->put(
+					MessageKey(peer, now->ids[i]),
+					std::move(shared->messages[i]));
+			}
+			database->put(IndexKey(peer), SerializeIndex(*now));
+		} else {
+			database->remove(IndexKey(peer));
+		}
+		crl::on_main(weak, [=] {
+			writeFinished(peer);
+		});
+	});
+}
+
+void MessagesDatabase::writeFinished(PeerId peer) {
+	_writing.remove(peer);
+	if (auto next = _pendingWrites.take(peer)) {
+		write(peer, std::move(*next));
+	}
+}
+
+void MessagesDatabase::close() {
+	_pendingWrites.clear();
+	_database->close();
+}
+
+void MessagesDatabase::clear() {
+	_database->clear();
+}
+
+} // namespace Storage
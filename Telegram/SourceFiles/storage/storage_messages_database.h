@@ -0,0 +1,62 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/weak_ptr.h"
+#include "storage/storage_databases.h"
+
+namespace Main {
+class Session;
+} // namespace Main
+
+namespace Storage {
+
+extern const char kOptionLocalMessagesDatabase[];
+
+struct MessagesDatabaseSlice {
+	QVector<MTPMessage> messages;
+	QVector<MTPUser> users;
+	QVector<MTPChat> chats;
+};
+
+// Encrypted on-disk copy of the latest messages of each opened chat,
+// used to show the chat before the server slice arrives.
+//
+// Each message is stored as a separate record keyed by (peer, msgId),
+// with a per-peer index record keyed by (peer, 0).
+class MessagesDatabase final : public base::has_weak_ptr {
+public:
+	explicit MessagesDatabase(not_null<Main::Session*> session);
+	~MessagesDatabase();
+
+	[[nodiscard]] static bool Enabled();
+
+	void putBottomSlice(PeerId peer, const MTPmessages_Messages &result);
+	void getBottomSlice(
+		PeerId peer,
+		Fn<void(MessagesDatabaseSlice&&)> done);
+	void removeHistory(PeerId peer);
+
+	void close();
+	void clear();
+
+private:
+	struct Write;
+
+	void write(PeerId peer, std::unique_ptr<Write> write);
+	void writeFinished(PeerId peer);
+
+	const not_null<Main::Session*> _session;
+	DatabasePointer _database;
+
+	base::flat_set<PeerId> _writing;
+	base::flat_map<PeerId, std::unique_ptr<Write>> _pendingWrites;
+
+};
+
+} // namespace Storage
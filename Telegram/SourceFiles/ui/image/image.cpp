@@ -7,6 +7,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #include "ui/image/image.h"
 
+#include "ui/image/image_cache.h"
 #include "storage/cache/storage_cache_database.h"
 #include "data/data_session.h"
 #include "main/main_session.h"
@@ -56,6 +57,13 @@ Image::Image(QImage &&data)
 	Expects(!_data.isNull());
 }
 
+Image::~Image() {
+	// Images prepared in background threads are destroyed there as well.
+	if (_hasCachedPixmaps) {
+		PixmapCache::Instance().forget(this);
+	}
+}
+
 not_null<Image*> Image::Empty() {
 	static auto result = Image([] {
 		const auto factor = style::DevicePixelRatio();
@@ -106,10 +114,12 @@ const QPixmap &Image::cached(
 	const auto outer = args.outer;
 	const auto size = outer.isEmpty() ? QSize(w, h) : outer * ratio;
 	const auto k = single ? SinglePixKey(args) : PixKey(w, h, args);
-	const auto i = _cache.find(k);
-	return (i != _cache.cend() && i->second.size() == size)
-		? i->second
-		: _cache.emplace_or_assign(k, prepare(w, h, args)).first->second;
+	auto &cache = PixmapCache::Instance();
+	if (const auto result = cache.find(this, k, size)) {
+		return *result;
+	}
+	_hasCachedPixmaps = true;
+	return cache.insert(this, k, prepare(w, h, args));
 }
 
 QPixmap Image::prepare(int w, int h, const Images::PrepareArgs &args) const {
@@ -16,6 +16,7 @@ public:
 	explicit Image(const QString &path);
 	explicit Image(const QByteArray &content);
 	explicit Image(QImage &&data);
+	~Image();
 
 	[[nodiscard]] static not_null<Image*> Empty(); // 1x1 transparent
 	[[nodiscard]] static not_null<Image*> BlankMedia(); // 1x1 black
@@ -36,6 +37,8 @@ public:
 
 	[[nodiscard]] QImage original() const;
 
+	// The returned references point into Images::PixmapCache and are
+	// valid only until the current event is handled, don't store them.
 	[[nodiscard]] const QPixmap &pix(
 			QSize size,
 			const Images::PrepareArgs &args = {}) const {
@@ -98,7 +101,8 @@ private:
 		const Images::PrepareArgs &args,
 		bool single) const;
 
+	// Scaled pixmaps live in the global Images::PixmapCache.
 	const QImage _data;
-	mutable base::flat_map<uint64, QPixmap> _cache;
+	mutable bool _hasCachedPixmaps = false;
 
 };
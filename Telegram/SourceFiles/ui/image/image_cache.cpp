@@ -0,0 +1,137 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "ui/image/image_cache.h"
+
+namespace Images {
+namespace {
+
+constexpr auto kDefaultBudget = int64(128 * 1024 * 1024);
+
+[[nodiscard]] int64 ComputeBytes(const QPixmap &pixmap) {
+	return int64(pixmap.width())
+		* pixmap.height()
+		* std::max(pixmap.depth(), 8)
+		/ 8;
+}
+
+} // namespace
+
+PixmapCache::PixmapCache()
+: _thread(std::this_thread::get_id())
+, _budget(kDefaultBudget) {
+}
+
+PixmapCache &PixmapCache::Instance() {
+	// Never destroyed, static Image-s forget their pixmaps on exit.
+	static const auto result = new PixmapCache();
+	return *result;
+}
+
+void PixmapCache::setBudget(int64 bytes) {
+	Expects(bytes >= 0);
+
+	_budget = bytes;
+	checkBudget();
+}
+
+int64 PixmapCache::budget() const {
+	return _budget;
+}
+
+PixmapCache::Stats PixmapCache::stats() const {
+	auto result = _stats;
+	result.count = int(_entries.size());
+	return result;
+}
+
+const QPixmap *PixmapCache::find(
+		not_null<const Image*> image,
+		uint64 key,
+		QSize size) {
+	const auto i = _entries.find(Key{ image.get(), key });
+	if (i == end(_entries) || i->second.pixmap.size() != size) {
+		++_stats.misses;
+		return nullptr;
+	}
+	++_stats.hits;
+	_lru.splice(end(_lru), _lru, i->second.lru);
+	return &i->second.pixmap;
+}
+
+const QPixmap &PixmapCache::insert(
+		not_null<const Image*> image,
+		uint64 key,
+		QPixmap &&pixmap) {
+	Expects(std::this_thread::get_id() == _thread);
+
+	const auto bytes = ComputeBytes(pixmap);
+	const auto k = Key{ image.get(), key };
+	auto i = _entries.find(k);
+	if (i != end(_entries)) {
+		_stats.bytes += bytes - i->second.bytes;
+		i->second.pixmap = std::move(pixmap);
+		i->second.bytes = bytes;
+		_lru.splice(end(_lru), _lru, i->second.lru);
+	} else {
+		_stats.bytes += bytes;
+		i = _entries.emplace(k, Entry{
+			.pixmap = std::move(pixmap),
+			.bytes = bytes,
+			.lru = _lru.insert(end(_lru), k),
+		}).first;
+	}
+	checkBudget();
+	return i->second.pixmap;
+}
+
+void PixmapCache::forget(not_null<const Image*> image) {
+	Expects(std::this_thread::get_id() == _thread);
+
+	auto i = _entries.lower_bound(Key{ image.get(), 0 });
+	while (i != end(_entries) && i->first.image == image) {
+		remove(i++);
+	}
+}
+
+void PixmapCache::remove(std::map<Key, Entry>::iterator i) {
+	_stats.bytes -= i->second.bytes;
+	_lru.erase(i->second.lru);
+	_entries.erase(i);
+}
+
+void PixmapCache::checkBudget() {
+	if (_stats.bytes <= _budget || _evictionScheduled) {
+		return;
+	}
+	_evictionScheduled = true;
+	crl::on_main([=] {
+		_evictionScheduled = false;
+		evict();
+	});
+}
+
+void PixmapCache::evict() {
+	auto evicted = 0;
+	while (_stats.bytes > _budget && !_lru.empty()) {
+		remove(_entries.find(_lru.front()));
+		++evicted;
+	}
+	if (evicted) {
+		_stats.evictions += evicted;
+		DEBUG_LOG(("Images Info: evicted %1 pixmaps, %2 left using %3 bytes "
+			"(hits %4, misses %5, evictions %6)."
+			).arg(evicted
+			).arg(_entries.size()
+			).arg(_stats.bytes
+			).arg(_stats.hits
+			).arg(_stats.misses
+			).arg(_stats.evictions));
+	}
+}
+
+} // namespace Images
@@ -0,0 +1,76 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include <thread>
+
+class Image;
+
+namespace Images {
+
+// Scaled pixmaps of all Image-s, limited by a byte budget, LRU evicted.
+// Main thread only (checked against the thread that created the cache).
+//
+// Image::pix() returns references to the cached pixmaps, so eviction is
+// postponed until the current event is handled and references taken
+// while painting stay valid.
+class PixmapCache final {
+public:
+	struct Stats {
+		int64 hits = 0;
+		int64 misses = 0;
+		int64 evictions = 0;
+		int64 bytes = 0;
+		int count = 0;
+	};
+
+	[[nodiscard]] static PixmapCache &Instance();
+
+	void setBudget(int64 bytes);
+	[[nodiscard]] int64 budget() const;
+	[[nodiscard]] Stats stats() const;
+
+	[[nodiscard]] const QPixmap *find(
+		not_null<const Image*> image,
+		uint64 key,
+		QSize size);
+	const QPixmap &insert(
+		not_null<const Image*> image,
+		uint64 key,
+		QPixmap &&pixmap);
+	void forget(not_null<const Image*> image);
+
+private:
+	struct Key {
+		const Image *image = nullptr;
+		uint64 key = 0;
+
+		friend inline auto operator<=>(Key, Key) = default;
+	};
+	struct Entry {
+		QPixmap pixmap;
+		int64 bytes = 0;
+		std::list<Key>::iterator lru;
+	};
+
+	PixmapCache();
+
+	void remove(std::map<Key, Entry>::iterator i);
+	void checkBudget();
+	void evict();
+
+	std::map<Key, Entry> _entries;
+	std::list<Key> _lru;
+	const std::thread::id _thread;
+	int64 _budget = 0;
+	Stats _stats;
+	bool _evictionScheduled = false;
+
+};
+
+} // namespace Images
@@ -0,0 +1,78 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "ui/image/image_read_scaled.h"
+
+#include <QtCore/QBuffer>
+#include <QtCore/QFile>
+#include <QtGui/QImageReader>
+
+namespace Images {
+namespace {
+
+// libjpeg can decode to 1/2, 1/4 and 1/8 of the size.
+constexpr auto kMaxDecodeDivider = 8;
+
+[[nodiscard]] QSize ChooseDecodeSize(QSize original, QSize target) {
+	auto divider = 1;
+	while (divider < kMaxDecodeDivider) {
+		const auto next = divider * 2;
+		if ((original.width() + next - 1) / next < target.width()
+			|| (original.height() + next - 1) / next < target.height()) {
+			break;
+		}
+		divider = next;
+	}
+	return QSize(
+		(original.width() + divider - 1) / divider,
+		(original.height() + divider - 1) / divider);
+}
+
+} // namespace
+
+QImage ReadScaled(ReadScaledArgs &&args) {
+	Expects(!args.box.isEmpty());
+
+	auto buffer = QBuffer(&args.content);
+	auto file = QFile(args.path);
+	const auto device = args.content.isEmpty()
+		? static_cast<QIODevice*>(&file)
+		: &buffer;
+	auto reader = QImageReader(device);
+	reader.setAutoTransform(true);
+	if (!reader.canRead()) {
+		return QImage();
+	}
+	const auto size = reader.size();
+	if (args.areaLimit > 0
+		&& int64(size.width()) * size.height() > args.areaLimit) {
+		return QImage();
+	} else if (!size.isEmpty()
+		&& reader.supportsOption(QImageIOHandler::ScaledSize)) {
+		// Scaled size is applied before the orientation transform.
+		const auto rotated = (reader.transformation()
+			& QImageIOHandler::TransformationRotate90);
+		const auto box = rotated ? args.box.transposed() : args.box;
+		const auto target = size.scaled(box, Qt::KeepAspectRatio);
+		if (target.width() < size.width()) {
+			reader.setScaledSize(ChooseDecodeSize(size, target));
+		}
+	}
+	auto result = reader.read();
+	if (result.isNull()) {
+		return result;
+	}
+	return (result.width() > args.box.width()
+		|| result.height() > args.box.height())
+		? result.scaled(
+			args.box,
+			Qt::KeepAspectRatio,
+			Qt::SmoothTransformation)
+		: result;
+}
+
+} // namespace Images
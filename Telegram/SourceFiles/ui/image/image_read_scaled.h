@@ -0,0 +1,27 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Images {
+
+struct ReadScaledArgs {
+	QString path;
+	QByteArray content;
+	QSize box;
+	int64 areaLimit = 0;
+};
+
+// Reads an image so that it fits the box, keeping the aspect ratio.
+//
+// Codecs that support it (JPEG with DCT scaling) skip the pixels that are
+// not needed: the image is decoded to the closest 1/2, 1/4 or 1/8 size
+// that still covers the box and only then smoothly scaled the rest of the
+// way, so a large photo is never fully decoded for a small preview.
+[[nodiscard]] QImage ReadScaled(ReadScaledArgs &&args);
+
+} // namespace Images
@@ -12,6 +12,107 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/image/image_prepare.h"
 
 namespace Ui {
+namespace {
+
+constexpr auto kUserpicAtlasBudget = int64(16 * 1024 * 1024);
+
+// Prepared cloud userpics, shared by all views of the same image in the
+// same size and shape: chats list rows, members lists, mentions, etc.
+//
+// Views hold implicitly shared copies of the prepared images, so an entry
+// is still in use while its image is not detached. Only unused entries
+// are evicted when the atlas goes over its budget. Main thread only.
+class UserpicAtlas final {
+public:
+	[[nodiscard]] static UserpicAtlas &Instance();
+
+	[[nodiscard]] QImage prepare(
+		const QImage &cloud,
+		int size,
+		PeerUserpicShape shape);
+
+private:
+	struct Key {
+		qint64 cloud = 0;
+		int size = 0;
+		PeerUserpicShape shape = PeerUserpicShape::Auto;
+
+		friend inline auto operator<=>(Key, Key) = default;
+	};
+	struct Entry {
+		QImage image;
+		std::list<Key>::iterator lru;
+	};
+
+	void evict();
+
+	std::map<Key, Entry> _entries;
+	std::list<Key> _lru;
+	int64 _bytes = 0;
+
+};
+
+[[nodiscard]] QImage PrepareCloudUserpic(
+		const QImage &cloud,
+		int size,
+		PeerUserpicShape shape) {
+	auto result = cloud.scaled(
+		QSize(size, size),
+		Qt::IgnoreAspectRatio,
+		Qt::SmoothTransformation);
+	if (shape == PeerUserpicShape::Monoforum) {
+		return Ui::ApplyMonoforumShape(std::move(result));
+	} else if (shape == PeerUserpicShape::Forum) {
+		return Images::Round(
+			std::move(result),
+			Images::CornersMask(size
+				* Ui::ForumUserpicRadiusMultiplier()
+				/ style::DevicePixelRatio()));
+	}
+	return Images::Circle(std::move(result));
+}
+
+UserpicAtlas &UserpicAtlas::Instance() {
+	static auto result = UserpicAtlas();
+	return result;
+}
+
+QImage UserpicAtlas::prepare(
+		const QImage &cloud,
+		int size,
+		PeerUserpicShape shape) {
+	const auto key = Key{ cloud.cacheKey(), size, shape };
+	if (const auto i = _entries.find(key); i != end(_entries)) {
+		_lru.splice(end(_lru), _lru, i->second.lru);
+		return i->second.image;
+	}
+	auto image = PrepareCloudUserpic(cloud, size, shape);
+	_bytes += image.sizeInBytes();
+	_entries.emplace(key, Entry{
+		.image = image,
+		.lru = _lru.insert(end(_lru), key),
+	});
+	if (_bytes > kUserpicAtlasBudget) {
+		evict();
+	}
+	return image;
+}
+
+void UserpicAtlas::evict() {
+	auto i = begin(_lru);
+	while (i != end(_lru) && _bytes > kUserpicAtlasBudget) {
+		const auto j = _entries.find(*i);
+		if (!j->second.image.isDetached()) {
+			++i;
+			continue;
+		}
+		_bytes -= j->second.image.sizeInBytes();
+		_entries.erase(j);
+		i = _lru.erase(i);
+	}
+}
+
+} // namespace
 
 float64 ForumUserpicRadiusMultiplier() {
 	return 0.3;
@@ -45,21 +146,7 @@ void ValidateUserpicCache(
 	view.paletteVersion = version;
 
 	if (cloud) {
-		view.cached = cloud->scaled(
-			full,
-			Qt::IgnoreAspectRatio,
-			Qt::SmoothTransformation);
-		if (shape == PeerUserpicShape::Monoforum) {
-			view.cached = Ui::ApplyMonoforumShape(std::move(view.cached));
-		} else if (shape == PeerUserpicShape::Forum) {
-			view.cached = Images::Round(
-				std::move(view.cached),
-				Images::CornersMask(size
-					* Ui::ForumUserpicRadiusMultiplier()
-					/ style::DevicePixelRatio()));
-		} else {
-			view.cached = Images::Circle(std::move(view.cached));
-		}
+		view.cached = UserpicAtlas::Instance().prepare(*cloud, size, shape);
 	} else {
 		if (view.cached.size() != full) {
 			view.cached = QImage(full, QImage::Format_ARGB32_Premultiplied);
@@ -13,6 +13,8 @@ PRIVATE
     ffmpeg/ffmpeg_frame_generator.cpp
     ffmpeg/ffmpeg_frame_generator.h
     ffmpeg/ffmpeg_bytes_io_wrap.h
+    ffmpeg/ffmpeg_premultiply.cpp
+    ffmpeg/ffmpeg_premultiply.h
     ffmpeg/ffmpeg_utility.cpp
     ffmpeg/ffmpeg_utility.h
 )
@@ -246,6 +246,8 @@ PRIVATE
     statistics/chart_rulers_data.h
     statistics/chart_widget.cpp
     statistics/chart_widget.h
+    statistics/min_max_pyramid.cpp
+    statistics/min_max_pyramid.h
     statistics/segment_tree.cpp
     statistics/segment_tree.h
     statistics/statistics_common.h